@@ -0,0 +1,152 @@
+#pragma once
+
+#include "computer_netlist.cpp"
+#include "gateif.h"
+#include "netlist.h"
+#include "signal.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+/// @return Index of the port of ComputerNetlist called @c name, or its number of ports if there is none.
+static constexpr size_t baked_port(const char* name)
+{
+    size_t i{};
+    for (const auto& p : ComputerNetlist::ports) {
+        size_t c{};
+        while (p.name[c] && p.name[c] == name[c]) {
+            ++c;
+        }
+        if (p.name[c] == name[c]) {
+            return i;
+        }
+        ++i;
+    }
+    return i;
+}
+
+/// @return Number of operations of ComputerNetlist with opcode @c code.
+static constexpr size_t baked_ops(Netlist::Opcode code)
+{
+    size_t count{};
+    for (const auto& op : ComputerNetlist::ops) {
+        count += (op.code == code);
+    }
+    return count;
+}
+
+// The NAND counts of the components follow from their structure in nand.cpp.
+// A change in structure fails here when the tables are regenerated, until the structure is restated.
+static_assert(ComputerNetlist::nands_NandGate == 1);
+static_assert(ComputerNetlist::nands_NotGate == ComputerNetlist::nands_NandGate);
+static_assert(ComputerNetlist::nands_AndGate == ComputerNetlist::nands_NandGate + ComputerNetlist::nands_NotGate);
+static_assert(ComputerNetlist::nands_DataLatchGate == ComputerNetlist::nands_SelectGate);
+static_assert(ComputerNetlist::nands_DataFlipFlop ==
+    ComputerNetlist::nands_AndGate + 2 * ComputerNetlist::nands_DataLatchGate + ComputerNetlist::nands_NotGate);
+static_assert(ComputerNetlist::nands_Register == 16 * ComputerNetlist::nands_DataFlipFlop);
+static_assert(ComputerNetlist::nands_HalfAdderGate == ComputerNetlist::nands_AndGate + ComputerNetlist::nands_XorGate);
+static_assert(ComputerNetlist::nands_FullAdderGate == 2 * ComputerNetlist::nands_HalfAdderGate + ComputerNetlist::nands_OrGate);
+static_assert(ComputerNetlist::nands_Add16Gate == 16 * ComputerNetlist::nands_FullAdderGate);
+static_assert(ComputerNetlist::nands_CombinedMemoryUnit == 2 * ComputerNetlist::nands_Register + ComputerNetlist::nands_Ram16x16);
+static_assert(ComputerNetlist::nands_Computer == ComputerNetlist::nands_Counter + ComputerNetlist::nands_Rom16x16 +
+    ComputerNetlist::nands_ControlUnit + ComputerNetlist::nands_CombinedMemoryUnit);
+static_assert(baked_ops(Netlist::NAND) == ComputerNetlist::nands_Computer);
+static_assert(baked_ops(Netlist::NAND) + baked_ops(Netlist::CONNECT) == std::size(ComputerNetlist::ops));
+
+/// Computer baked into the binary.
+/// Evaluates the netlist of a gate-level Computer, generated at build time by nandgen -t as the constant tables of
+/// ComputerNetlist, so that construction builds no gates and allocates nothing:
+/// it copies the initial signal values, and loads the program into the ROM signals.
+/// Behaves exactly as Computer.
+class BakedComputer : public Gate
+{
+    static constexpr size_t PC = baked_port("pc");
+    static constexpr size_t A = baked_port("a");
+    static constexpr size_t D = baked_port("d");
+    static constexpr size_t PA = baked_port("pa");
+    static constexpr size_t ROM0 = baked_port("rom0");
+    static constexpr size_t RAM0 = baked_port("ram0");
+
+    static_assert(std::max({PC, A, D, PA, ROM0, RAM0}) < std::size(ComputerNetlist::ports), "no such port");
+    static_assert(baked_port("rom15") == ROM0 + 15, "ROM ports must be consecutive");
+    static_assert(baked_port("ram15") == RAM0 + 15, "RAM ports must be consecutive");
+
+    Signal& clk_;
+    Signal& halt_;
+    std::array<uint8_t, ComputerNetlist::signals> state_;
+
+    uint16_t getint(size_t port) const
+    {
+        const auto& p = ComputerNetlist::ports[port];
+        uint16_t x{};
+        for (size_t bit = 0; bit < p.size; ++bit) {
+            x = static_cast<uint16_t>(x | (state_[p.bits[bit]] << bit));
+        }
+        return x;
+    }
+
+    void setint(size_t port, uint16_t x)
+    {
+        const auto& p = ComputerNetlist::ports[port];
+        for (size_t bit = 0; bit < p.size; ++bit) {
+            state_[p.bits[bit]] = (x >> bit) & 1;
+        }
+    }
+
+public:
+    BakedComputer(std::vector<uint16_t>& program, Signal& clk, Signal& halt) :
+        clk_{clk},
+        halt_{halt}
+    {
+        memcpy(state_.data(), ComputerNetlist::initial, sizeof(ComputerNetlist::initial));
+        for (size_t address = 0; address < 16; ++address) {
+            setint(ROM0 + address, program[address]);
+        }
+    }
+
+    uint16_t pc() const
+    {
+        return getint(PC);
+    }
+
+    uint16_t a() const
+    {
+        return getint(A);
+    }
+
+    uint16_t d() const
+    {
+        return getint(D);
+    }
+
+    uint16_t pa() const
+    {
+        return getint(PA);
+    }
+
+    /// @return RAM contents at @c address.
+    uint16_t ram(size_t address) const
+    {
+        return getint(RAM0 + address);
+    }
+
+    /// @return ROM contents at @c address.
+    uint16_t rom(size_t address) const
+    {
+        return getint(ROM0 + address);
+    }
+
+    void update() override
+    {
+        state_[ComputerNetlist::port_clk[0]] = static_cast<uint8_t>(clk_.get());
+        for (const auto& op : ComputerNetlist::ops) {
+            state_[op.out] = Netlist::apply(op.code, state_[op.a], state_[op.b]);
+        }
+        halt_.set(state_[ComputerNetlist::port_halt[0]]);
+    }
+};
@@ -0,0 +1,178 @@
+#include "batch.h"
+#include "nand.cpp"
+
+#include <algorithm>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+/// Job queue of one worker.
+/// The owner takes jobs from the back, thieves from the front.
+class WorkQueue
+{
+    std::mutex mutex_;
+    std::deque<size_t> jobs_;
+
+public:
+    void push(size_t job)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        jobs_.push_back(job);
+    }
+
+    bool pop(size_t& job)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (jobs_.empty()) {
+            return false;
+        }
+        job = jobs_.back();
+        jobs_.pop_back();
+        return true;
+    }
+
+    bool steal(size_t& job)
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (jobs_.empty()) {
+            return false;
+        }
+        job = jobs_.front();
+        jobs_.pop_front();
+        return true;
+    }
+};
+
+static std::vector<uint8_t> read_file(const std::string& path)
+{
+    std::ifstream in{path, std::ios::binary};
+    if (!in) {
+        throw std::runtime_error("cannot read " + path);
+    }
+    return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+
+static std::vector<uint16_t> image(const uint8_t* bytes, size_t size)
+{
+    std::vector<uint16_t> program(16);
+    for (size_t i = 0; i + 1 < size; i += 2) {
+        program[i / 2] = static_cast<uint16_t>(bytes[i] | (bytes[i + 1] << 8));
+    }
+    return program;
+}
+
+std::vector<BatchJob> load_batch(const std::string& path)
+{
+    std::vector<BatchJob> jobs;
+
+    if (std::filesystem::is_directory(path)) {
+        std::vector<std::string> files;
+        for (const auto& entry : std::filesystem::directory_iterator{path}) {
+            if (entry.is_regular_file()) {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+
+        for (const auto& file : files) {
+            auto bytes = read_file(file);
+            if (bytes.size() > 32 || bytes.size() % 2) {
+                throw std::runtime_error("bad ROM image size: " + file);
+            }
+            jobs.push_back(BatchJob{file, image(bytes.data(), bytes.size())});
+        }
+        return jobs;
+    }
+
+    auto bytes = read_file(path);
+    if (bytes.size() % 32) {
+        throw std::runtime_error("bad packed ROM file size: " + path);
+    }
+    for (size_t i = 0; i < bytes.size(); i += 32) {
+        jobs.push_back(BatchJob{path + ":" + std::to_string(i / 32), image(&bytes[i], 32)});
+    }
+    return jobs;
+}
+
+static BatchResult run_job(const BatchJob& job, uint64_t budget)
+{
+    std::vector<uint16_t> program = job.program;
+    program.resize(16);
+
+    Signal clk;
+    Signal halt;
+    Computer g{program, clk, halt};
+
+    uint64_t cycles{};
+    while (!halt.get() && cycles < budget) {
+        clk.set(1);
+        g.update();
+        clk.set(0);
+        g.update();
+        cycles++;
+    }
+
+    BatchResult r{g.pc(), g.a(), g.d(), g.pa(), {}, cycles, halt.get() != 0};
+    for (size_t address = 0; address < 16; ++address) {
+        r.ram.push_back(g.ram(address));
+    }
+    return r;
+}
+
+std::vector<BatchResult> run_batch(const std::vector<BatchJob>& jobs, uint64_t budget, unsigned threads)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(jobs.size(), 1)));
+
+    std::vector<WorkQueue> queues(threads);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        queues[i % threads].push(i);
+    }
+
+    std::vector<BatchResult> results(jobs.size());
+    auto work = [&](unsigned self)
+    {
+        size_t job;
+        for (;;) {
+            bool found = queues[self].pop(job);
+            for (unsigned k = 1; !found && k < threads; ++k) {
+                found = queues[(self + k) % threads].steal(job);
+            }
+            if (!found) {
+                // No job is ever added, so every queue stays empty.
+                return;
+            }
+            results[job] = run_job(jobs[job], budget);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back(work, i);
+    }
+    work(0);
+    for (auto& t : workers) {
+        t.join();
+    }
+
+    return results;
+}
+
+void print_batch(const std::vector<BatchJob>& jobs, const std::vector<BatchResult>& results, FILE* f)
+{
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const auto& r = results[i];
+        fprintf(f, "%s %s CYCLES:%llu PC:%04x A:%04x D:%04x PA:%04x RAM:", jobs[i].name.c_str(),
+            r.halted ? "HALT" : "BUDGET", static_cast<unsigned long long>(r.cycles), r.pc, r.a, r.d, r.pa);
+        for (auto word : r.ram) {
+            fprintf(f, " %04x", word);
+        }
+        fprintf(f, "\n");
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// One job of a batch: a ROM image.
+struct BatchJob
+{
+    std::string name;
+    std::vector<uint16_t> program;
+};
+
+/// Final state of one job.
+struct BatchResult
+{
+    uint16_t pc;
+    uint16_t a;
+    uint16_t d;
+    uint16_t pa;
+    std::vector<uint16_t> ram;
+    uint64_t cycles;
+    bool halted;
+};
+
+/// Load ROM images from @c path.
+/// A ROM image is up to 16 little-endian 16-bit words, padded with zeros.
+/// If @c path is a directory, each regular file in it is one image, in name order.
+/// Otherwise @c path is a packed file of 32-byte images, named path:index.
+/// @throws std::runtime_error if an image cannot be read or has the wrong size.
+std::vector<BatchJob> load_batch(const std::string& path);
+
+/// Run each job on its own Computer until it halts or has run @c budget cycles.
+/// Jobs are spread over @c threads worker threads (all cores if zero), each with its own queue;
+/// a worker whose queue is empty steals jobs from the others.
+/// @return Results, in job order.
+std::vector<BatchResult> run_batch(const std::vector<BatchJob>& jobs, uint64_t budget, unsigned threads);
+
+/// Print one line per job.
+void print_batch(const std::vector<BatchJob>& jobs, const std::vector<BatchResult>& results, FILE* f);
@@ -0,0 +1,350 @@
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "example.cpp"
+#include "fast.cpp"
+#include "flat.cpp"
+#include "programs.cpp"
+
+/// One benchmark: run() performs @c n iterations of the measured operation, e.g. @c n clock cycles.
+struct Benchmark
+{
+    std::string name;
+    std::string unit;
+    std::function<void(uint64_t n)> run;
+};
+
+/// Measured rates of one benchmark, in @c unit per second.
+struct Measurement
+{
+    const Benchmark* benchmark;
+    uint64_t iterations;
+    std::vector<double> rates;
+};
+
+/// @return Percentile @c p (0..100) of sorted @c v, interpolating linearly.
+static double percentile(const std::vector<double>& v, double p)
+{
+    double rank = p / 100 * static_cast<double>(v.size() - 1);
+    size_t i = static_cast<size_t>(rank);
+    if (i + 1 >= v.size()) {
+        return v.back();
+    }
+    return v[i] + (rank - static_cast<double>(i)) * (v[i + 1] - v[i]);
+}
+
+/// @return Seconds taken by @c n iterations of @c b.
+static double elapsed(const Benchmark& b, uint64_t n)
+{
+    auto start = std::chrono::steady_clock::now();
+    b.run(n);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// Measure @c b.
+/// Warm-up doubles the iteration count until one repetition takes at least @c min_time seconds,
+/// then @c warmup more repetitions are discarded, and @c repetitions are measured.
+static Measurement measure(const Benchmark& b, double min_time, unsigned warmup, unsigned repetitions)
+{
+    uint64_t n = 1;
+    while (elapsed(b, n) < min_time) {
+        n *= 2;
+    }
+    for (unsigned i = 0; i < warmup; ++i) {
+        elapsed(b, n);
+    }
+
+    Measurement m{&b, n, {}};
+    for (unsigned i = 0; i < repetitions; ++i) {
+        m.rates.push_back(static_cast<double>(n) / elapsed(b, n));
+    }
+    std::sort(m.rates.begin(), m.rates.end());
+    return m;
+}
+
+/// Full computer @c Model running @c program, one clock cycle per iteration.
+/// The program is not stopped at halt: the clock keeps running, as in hardware.
+template <typename Model>
+static Benchmark computer(const std::string& name, std::vector<uint16_t> program)
+{
+    struct Fixture
+    {
+        std::vector<uint16_t> program;
+        Signal clk;
+        Signal halt;
+        Model g;
+
+        explicit Fixture(std::vector<uint16_t> p) :
+            program{std::move(p)},
+            g{program, clk, halt}
+        {
+        }
+    };
+
+    auto f = std::make_shared<Fixture>(std::move(program));
+    return Benchmark{name, "cycles/s", [f](uint64_t n)
+    {
+        for (uint64_t i = 0; i < n; ++i) {
+            f->clk.set(1);
+            f->g.update();
+            f->clk.set(0);
+            f->g.update();
+        }
+    }};
+}
+
+/// Computer with every block behavioral.
+class BehavioralComputer : public Computer
+{
+public:
+    BehavioralComputer(std::vector<uint16_t>& program, Signal& clk, Signal& halt) :
+        Computer{program, clk, halt, BEHAVIORAL_ALL}
+    {
+    }
+};
+
+/// FastComputer running @c program, one whole clock cycle (step()) per iteration.
+static Benchmark fast(const std::string& name, std::vector<uint16_t> program)
+{
+    struct Fixture
+    {
+        std::vector<uint16_t> program;
+        Signal clk;
+        Signal halt;
+        FastComputer g;
+
+        explicit Fixture(std::vector<uint16_t> p) :
+            program{std::move(p)},
+            g{program, clk, halt}
+        {
+        }
+    };
+
+    auto f = std::make_shared<Fixture>(std::move(program));
+    return Benchmark{name, "cycles/s", [f](uint64_t n)
+    {
+        for (uint64_t i = 0; i < n; ++i) {
+            f->g.step();
+        }
+    }};
+}
+
+/// Inputs for microbenchmarks: a fixed pseudo-random sequence.
+static std::vector<uint16_t> inputs()
+{
+    std::vector<uint16_t> v;
+    uint32_t seed = 1;
+    for (size_t i = 0; i < 256; ++i) {
+        seed = seed * 1103515245 + 12345;
+        v.push_back(static_cast<uint16_t>(seed >> 16));
+    }
+    return v;
+}
+
+/// Gate of @c Fixture, with fresh inputs and one update() per iteration.
+/// @c Fixture holds the gate and its signals; set(f, x) applies input @c x.
+template <typename Fixture>
+static Benchmark gate(const std::string& name, std::function<void(Fixture&, uint16_t)> set)
+{
+    auto f = std::make_shared<Fixture>();
+    auto in = std::make_shared<std::vector<uint16_t>>(inputs());
+    return Benchmark{name, "updates/s", [f, in, set](uint64_t n)
+    {
+        for (uint64_t i = 0; i < n; ++i) {
+            set(*f, (*in)[i & 255]);
+            f->g.update();
+        }
+    }};
+}
+
+struct AddFixture
+{
+    SignalSet16 a;
+    SignalSet16 b;
+    Signal c_in;
+    SignalSet16 s;
+    Signal c_out;
+    Add16Gate g{a, b, c_in, s, c_out};
+};
+
+struct MuxFixture
+{
+    SignalSet16 in;
+    SignalSet16 ad;
+    Signal out;
+    Mux16to1Gate g{in, ad, out};
+};
+
+struct DecoderFixture
+{
+    SignalSet16 in;
+    SignalSet16 out;
+    Decoder4to16Gate g{in, out};
+};
+
+struct RamFixture
+{
+    Signal st;
+    SignalSet16 x;
+    SignalSet16 ad;
+    Signal clk;
+    SignalSet16 out;
+    Ram16x16 g{st, x, ad, clk, out};
+};
+
+struct AluFixture
+{
+    Signal u;
+    Signal op1;
+    Signal op0;
+    Signal zx;
+    Signal sw;
+    SignalSet16 x;
+    SignalSet16 y;
+    SignalSet16 out;
+    ArithmeticAndLogicUnit g{u, op1, op0, zx, sw, x, y, out};
+};
+
+static std::vector<Benchmark> benchmarks()
+{
+    std::vector<std::pair<std::string, std::vector<uint16_t>>> programs{
+        {"example", example_program()},
+        {"memory", memory_program()},
+        {"random", random_program(1)},
+    };
+
+    std::vector<Benchmark> v;
+    for (const auto& p : programs) {
+        v.push_back(computer<Computer>("computer/" + p.first, p.second));
+        v.push_back(computer<BehavioralComputer>("behavioral/" + p.first, p.second));
+        v.push_back(computer<FlatComputer>("flat/" + p.first, p.second));
+        v.push_back(computer<OptimizedComputer>("optimized/" + p.first, p.second));
+        v.push_back(computer<JitComputer>("jit/" + p.first, p.second));
+        v.push_back(fast("fast/" + p.first, p.second));
+    }
+
+    v.push_back(gate<AddFixture>("gate/Add16Gate", [](AddFixture& f, uint16_t x)
+    {
+        f.a.setint(x);
+        f.b.setint(static_cast<uint16_t>(x * 31));
+        f.c_in.set(x & 1);
+    }));
+    v.push_back(gate<MuxFixture>("gate/Mux16to1Gate", [](MuxFixture& f, uint16_t x)
+    {
+        f.in.setint(x);
+        f.ad.setint(x >> 12);
+    }));
+    v.push_back(gate<DecoderFixture>("gate/Decoder4to16Gate", [](DecoderFixture& f, uint16_t x)
+    {
+        f.in.setint(x & 15);
+    }));
+    v.push_back(gate<RamFixture>("gate/Ram16x16", [](RamFixture& f, uint16_t x)
+    {
+        f.st.set(x & 1);
+        f.clk.set((x >> 1) & 1);
+        f.x.setint(x);
+        f.ad.setint(x >> 12);
+    }));
+    v.push_back(gate<AluFixture>("gate/ArithmeticAndLogicUnit", [](AluFixture& f, uint16_t x)
+    {
+        f.u.set(x & 1);
+        f.op1.set((x >> 1) & 1);
+        f.op0.set((x >> 2) & 1);
+        f.zx.set((x >> 3) & 1);
+        f.sw.set((x >> 4) & 1);
+        f.x.setint(x);
+        f.y.setint(static_cast<uint16_t>(x * 31));
+    }));
+    return v;
+}
+
+static void print_json(const std::vector<Measurement>& measurements, unsigned warmup, FILE* f)
+{
+    fprintf(f, "{\n");
+    fprintf(f, "  \"warmup\": %u,\n", warmup);
+    fprintf(f, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < measurements.size(); ++i) {
+        const auto& m = measurements[i];
+        fprintf(f, "    {\"name\": \"%s\", \"unit\": \"%s\", \"iterations\": %" PRIu64 ", \"repetitions\": %zu, "
+            "\"min\": %.1f, \"p10\": %.1f, \"median\": %.1f, \"p90\": %.1f, \"max\": %.1f}%s\n",
+            m.benchmark->name.c_str(), m.benchmark->unit.c_str(), m.iterations, m.rates.size(),
+            m.rates.front(), percentile(m.rates, 10), percentile(m.rates, 50), percentile(m.rates, 90), m.rates.back(),
+            i + 1 < measurements.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n");
+    fprintf(f, "}\n");
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: nand_bench [-f filter] [-r repetitions] [-t min-time] [-w warmup] [-o json-file]\n");
+    exit(2);
+}
+
+/// Benchmark the engines on the standard programs, and the main gates.
+/// Reports median, 10th and 90th percentile rates; with -o, also writes them as JSON.
+int main(int argc, char* argv[])
+{
+    std::string filter;
+    unsigned repetitions = 11;
+    double min_time = 0.02;
+    unsigned warmup = 2;
+    const char* json{};
+
+    int c;
+    while ((c = getopt(argc, argv, "f:o:r:t:w:")) != -1) {
+        switch (c) {
+        case 'f':
+            filter = optarg;
+            break;
+        case 'o':
+            json = optarg;
+            break;
+        case 'r':
+            repetitions = std::max(1u, static_cast<unsigned>(strtoul(optarg, nullptr, 0)));
+            break;
+        case 't':
+            min_time = strtod(optarg, nullptr);
+            break;
+        case 'w':
+            warmup = static_cast<unsigned>(strtoul(optarg, nullptr, 0));
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind != argc) {
+        usage();
+    }
+
+    auto all = benchmarks();
+    std::vector<Measurement> measurements;
+    printf("%-32s %14s %14s %14s  %s\n", "benchmark", "p10", "median", "p90", "unit");
+    for (const auto& b : all) {
+        if (b.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        measurements.push_back(measure(b, min_time, warmup, repetitions));
+        const auto& m = measurements.back();
+        printf("%-32s %14.0f %14.0f %14.0f  %s\n", b.name.c_str(), percentile(m.rates, 10), percentile(m.rates, 50), percentile(m.rates, 90), b.unit.c_str());
+        fflush(stdout);
+    }
+
+    if (json) {
+        FILE* f = fopen(json, "w");
+        if (!f) {
+            perror(json);
+            return 1;
+        }
+        print_json(measurements, warmup, f);
+        fclose(f);
+    }
+}
@@ -0,0 +1,192 @@
+#include "census.h"
+#include "signal.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <new>
+#include <typeinfo>
+#include <vector>
+
+/// Allocation counters, only updated while a census is active.
+static std::atomic<bool> counting{};
+static std::atomic<uint64_t> allocation_count{};
+static std::atomic<uint64_t> allocated_bytes{};
+static std::atomic<uint64_t> freed_bytes{};
+
+/// Each allocation is preceded by a header holding its size, so that frees can be counted in bytes.
+static const size_t header = alignof(std::max_align_t);
+
+static void* allocate(size_t size) noexcept
+{
+    auto p = static_cast<char*>(malloc(size + header));
+    if (!p) {
+        return nullptr;
+    }
+    *reinterpret_cast<size_t*>(p) = size;
+    if (counting.load(std::memory_order_relaxed)) {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    return p + header;
+}
+
+static void release(void* q) noexcept
+{
+    if (!q) {
+        return;
+    }
+    auto p = static_cast<char*>(q) - header;
+    if (counting.load(std::memory_order_relaxed)) {
+        freed_bytes.fetch_add(*reinterpret_cast<size_t*>(p), std::memory_order_relaxed);
+    }
+    free(p);
+}
+
+// Every non-aligned form is replaced, so that none of them reaches another allocator.
+
+void* operator new(size_t size)
+{
+    void* p = allocate(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    release(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    release(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    release(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    release(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    release(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    release(p);
+}
+
+Census::Census() :
+    signals_{},
+    allocations_{},
+    bytes_{},
+    live_bytes_{},
+    seconds_{},
+    active_{true}
+{
+    Gate::observe(this);
+    Signal::constructed_ = &signals_;
+    allocation_count = 0;
+    allocated_bytes = 0;
+    freed_bytes = 0;
+    counting = true;
+    start_ = std::chrono::steady_clock::now();
+}
+
+Census::~Census()
+{
+    stop();
+}
+
+// Bookkeeping of the census itself is not counted.
+
+void Census::constructed(Gate* g)
+{
+    counting = false;
+    gates_.insert(g);
+    counting = true;
+}
+
+void Census::destroyed(Gate* g)
+{
+    counting = false;
+    gates_.erase(g);
+    counting = true;
+}
+
+void Census::stop()
+{
+    if (!active_) {
+        return;
+    }
+
+    seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    counting = false;
+    active_ = false;
+    Gate::observe(nullptr);
+    Signal::constructed_ = nullptr;
+
+    allocations_ = allocation_count;
+    bytes_ = allocated_bytes;
+    live_bytes_ = allocated_bytes - freed_bytes;
+
+    for (auto g : gates_) {
+        const char* mangled = typeid(*g).name();
+        int status;
+        char* name = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+        classes_[status == 0 ? name : mangled]++;
+        free(name);
+    }
+    gates_.clear();
+}
+
+size_t Census::gates() const
+{
+    size_t n{};
+    for (const auto& c : classes_) {
+        n += c.second;
+    }
+    return n;
+}
+
+void Census::print(FILE* f) const
+{
+    fprintf(f, "time: %.3f ms\n", seconds_ * 1e3);
+    fprintf(f, "allocations: %" PRIu64 " (%" PRIu64 " bytes, %" PRIu64 " live)\n", allocations_, bytes_, live_bytes_);
+    fprintf(f, "signals: %" PRIu64 "\n", signals_);
+    fprintf(f, "gates: %zu\n", gates());
+
+    std::vector<std::pair<std::string, size_t>> v{classes_.begin(), classes_.end()};
+    std::stable_sort(v.begin(), v.end(), [](const auto& x, const auto& y)
+    {
+        return x.second > y.second;
+    });
+    for (const auto& c : v) {
+        fprintf(f, "  %8zu %s\n", c.second, c.first.c_str());
+    }
+}
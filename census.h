@@ -0,0 +1,97 @@
+#pragma once
+
+#include "gateif.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+/// Construction census.
+/// Counts, from construction until stop(): heap allocations and bytes (by replacing the global operator new),
+/// gates by class, signals, and wall-clock time.
+/// Gates are counted if they are alive when stopped, i.e. temporaries are not counted.
+/// Only one census may be active at a time, and no other thread may allocate meanwhile.
+/// Linking this module replaces operator new and delete for the whole program.
+class Census : public Gate::Observer
+{
+    std::unordered_set<Gate*> gates_;
+    std::map<std::string, size_t> classes_;
+    uint64_t signals_;
+    uint64_t allocations_;
+    uint64_t bytes_;
+    uint64_t live_bytes_;
+    std::chrono::steady_clock::time_point start_;
+    double seconds_;
+    bool active_;
+
+public:
+    /// Start counting.
+    Census();
+    Census(const Census&) = delete;
+    Census& operator=(const Census&) = delete;
+    ~Census() override;
+
+    void constructed(Gate* g) override;
+    void destroyed(Gate* g) override;
+
+    /// Stop counting, and classify the gates still alive.
+    void stop();
+
+    /// @return Number of heap allocations.
+    uint64_t allocations() const
+    {
+        return allocations_;
+    }
+
+    /// @return Number of bytes allocated.
+    uint64_t bytes() const
+    {
+        return bytes_;
+    }
+
+    /// @return Number of bytes allocated and not freed.
+    uint64_t live_bytes() const
+    {
+        return live_bytes_;
+    }
+
+    /// @return Number of signals constructed.
+    uint64_t signals() const
+    {
+        return signals_;
+    }
+
+    /// @return Number of gates, by class name.
+    const std::map<std::string, size_t>& classes() const
+    {
+        return classes_;
+    }
+
+    /// @return Number of gates.
+    size_t gates() const;
+
+    /// @return Elapsed time in seconds.
+    double seconds() const
+    {
+        return seconds_;
+    }
+
+    /// Print report.
+    void print(FILE* f) const;
+};
+
+/// Construct @c G from @c args under a census.
+/// @return Census, and the gate (whose destruction is not counted).
+template <typename G, typename... Args>
+std::pair<std::unique_ptr<Census>, std::unique_ptr<G>> census(Args&&... args)
+{
+    auto c = std::make_unique<Census>();
+    auto g = std::make_unique<G>(std::forward<Args>(args)...);
+    c->stop();
+    return {std::move(c), std::move(g)};
+}
@@ -0,0 +1,209 @@
+#include "codegen.h"
+
+#include <algorithm>
+#include <cstdint>
+
+void generate(const Netlist& n, const std::vector<std::string>& inputs, FILE* f)
+{
+    const auto& ops = n.ops();
+    const size_t count = n.signals();
+    const uint32_t none = ~uint32_t{};
+
+    std::vector<uint32_t> writes(count);
+    std::vector<uint32_t> first_write(count, none);
+    std::vector<uint32_t> first_read(count, none);
+    for (uint32_t i = 0; i < ops.size(); ++i) {
+        first_read[ops[i].a] = std::min(first_read[ops[i].a], i);
+        first_read[ops[i].b] = std::min(first_read[ops[i].b], i);
+        first_write[ops[i].out] = std::min(first_write[ops[i].out], i);
+        writes[ops[i].out]++;
+    }
+
+    std::vector<uint8_t> input(count);
+    std::vector<uint8_t> observed(count);
+    for (const auto& p : n.ports()) {
+        bool is_input = std::find(inputs.begin(), inputs.end(), p.name) != inputs.end();
+        for (auto s : p.bits) {
+            observed[s] = 1;
+            input[s] = is_input;
+        }
+    }
+
+    enum Kind { CONSTANT, STATE, LOCAL };
+    std::vector<Kind> kind(count);
+    std::vector<uint32_t> slot(count);
+    uint32_t slots{};
+    for (size_t s = 0; s < count; ++s) {
+        if (writes[s] == 0) {
+            kind[s] = input[s] ? STATE : CONSTANT;
+        } else if (writes[s] > 1 || observed[s] || first_read[s] <= first_write[s]) {
+            kind[s] = STATE;
+        } else {
+            kind[s] = LOCAL;
+        }
+
+        if (kind[s] == STATE) {
+            slot[s] = slots++;
+        }
+    }
+
+    // Liveness: state is always live, locals only if read by a live operation.
+    std::vector<uint8_t> live(count);
+    std::vector<uint8_t> live_op(ops.size());
+    for (size_t s = 0; s < count; ++s) {
+        live[s] = (kind[s] == STATE);
+    }
+    for (size_t i = ops.size(); i-- > 0;) {
+        if (live[ops[i].out]) {
+            live_op[i] = 1;
+            live[ops[i].a] = 1;
+            live[ops[i].b] = 1;
+        }
+    }
+
+    auto name = [&](uint32_t s)
+    {
+        switch (kind[s]) {
+        case CONSTANT:
+            return std::string{n.initial()[s] ? "1" : "0"};
+        case STATE:
+            return "s.v[" + std::to_string(slot[s]) + "]";
+        case LOCAL:
+            break;
+        }
+        return "v" + std::to_string(s);
+    };
+
+    fprintf(f, "// Generated by nandgen. Do not edit.\n");
+    fprintf(f, "// %zu signals, %zu operations.\n", count, ops.size());
+    fprintf(f, "\n");
+    fprintf(f, "#include <cstdint>\n");
+    fprintf(f, "\n");
+    fprintf(f, "struct State\n");
+    fprintf(f, "{\n");
+    fprintf(f, "    uint8_t v[%u];\n", std::max(slots, uint32_t{1}));
+    fprintf(f, "};\n");
+    fprintf(f, "\n");
+    fprintf(f, "inline State initial()\n");
+    fprintf(f, "{\n");
+    fprintf(f, "    State s{};\n");
+    for (size_t s = 0; s < count; ++s) {
+        if (kind[s] == STATE && n.initial()[s]) {
+            fprintf(f, "    s.v[%u] = 1;\n", slot[s]);
+        }
+    }
+    fprintf(f, "    return s;\n");
+    fprintf(f, "}\n");
+    fprintf(f, "\n");
+    fprintf(f, "inline void step(State& s)\n");
+    fprintf(f, "{\n");
+    for (size_t i = 0; i < ops.size(); ++i) {
+        if (!live_op[i]) {
+            continue;
+        }
+
+        const auto& op = ops[i];
+        std::string out = (kind[op.out] == LOCAL ? "const uint8_t " : "") + name(op.out);
+        switch (op.code) {
+        case Netlist::NAND:
+            fprintf(f, "    %s = !(%s & %s);\n", out.c_str(), name(op.a).c_str(), name(op.b).c_str());
+            break;
+        case Netlist::CONNECT:
+            fprintf(f, "    %s = %s;\n", out.c_str(), name(op.a).c_str());
+            break;
+        case Netlist::AND:
+            fprintf(f, "    %s = %s & %s;\n", out.c_str(), name(op.a).c_str(), name(op.b).c_str());
+            break;
+        case Netlist::OR:
+            fprintf(f, "    %s = %s | %s;\n", out.c_str(), name(op.a).c_str(), name(op.b).c_str());
+            break;
+        }
+    }
+    fprintf(f, "}\n");
+
+    for (const auto& p : n.ports()) {
+        bool stored = std::all_of(p.bits.begin(), p.bits.end(), [&](uint32_t s) { return kind[s] == STATE; });
+        if (!stored) {
+            continue;
+        }
+
+        fprintf(f, "\n");
+        fprintf(f, "inline uint16_t get_%s(const State& s)\n", p.name.c_str());
+        fprintf(f, "{\n");
+        fprintf(f, "    return static_cast<uint16_t>(0");
+        for (size_t bit = 0; bit < p.bits.size(); ++bit) {
+            fprintf(f, " | %s << %zu", name(p.bits[bit]).c_str(), bit);
+        }
+        fprintf(f, ");\n");
+        fprintf(f, "}\n");
+
+        if (std::find(inputs.begin(), inputs.end(), p.name) != inputs.end()) {
+            fprintf(f, "\n");
+            fprintf(f, "inline void set_%s(State& s, uint16_t x)\n", p.name.c_str());
+            fprintf(f, "{\n");
+            for (size_t bit = 0; bit < p.bits.size(); ++bit) {
+                fprintf(f, "    %s = (x >> %zu) & 1;\n", name(p.bits[bit]).c_str(), bit);
+            }
+            fprintf(f, "}\n");
+        }
+    }
+}
+
+void generate_tables(const Netlist& n, const std::string& name, const std::vector<std::pair<std::string, size_t>>& components, FILE* f)
+{
+    static const char* const opcodes[] = {"NAND", "CONNECT", "AND", "OR"};
+
+    fprintf(f, "// Generated by nandgen -t. Do not edit.\n");
+    fprintf(f, "// %zu signals, %zu operations.\n", n.signals(), n.ops().size());
+    fprintf(f, "\n");
+    fprintf(f, "#pragma once\n");
+    fprintf(f, "\n");
+    fprintf(f, "#include \"netlist.h\"\n");
+    fprintf(f, "\n");
+    fprintf(f, "#include <cstddef>\n");
+    fprintf(f, "#include <cstdint>\n");
+    fprintf(f, "\n");
+    fprintf(f, "struct %s\n", name.c_str());
+    fprintf(f, "{\n");
+    fprintf(f, "    struct Port\n");
+    fprintf(f, "    {\n");
+    fprintf(f, "        const char* name;\n");
+    fprintf(f, "        const uint32_t* bits;\n");
+    fprintf(f, "        size_t size;\n");
+    fprintf(f, "    };\n");
+    fprintf(f, "\n");
+    fprintf(f, "    static constexpr size_t signals = %zu;\n", n.signals());
+    fprintf(f, "\n");
+    fprintf(f, "    static constexpr uint8_t initial[signals] = {");
+    for (size_t s = 0; s < n.signals(); ++s) {
+        fprintf(f, "%s%s%u", s ? "," : "", s % 32 ? " " : "\n        ", n.initial()[s]);
+    }
+    fprintf(f, "\n    };\n");
+    fprintf(f, "\n");
+    fprintf(f, "    static constexpr Netlist::Op ops[] = {\n");
+    for (const auto& op : n.ops()) {
+        fprintf(f, "        {Netlist::%s, %u, %u, %u},\n", opcodes[op.code], op.a, op.b, op.out);
+    }
+    fprintf(f, "    };\n");
+    fprintf(f, "\n");
+    for (const auto& p : n.ports()) {
+        fprintf(f, "    static constexpr uint32_t port_%s[] = {", p.name.c_str());
+        for (size_t bit = 0; bit < p.bits.size(); ++bit) {
+            fprintf(f, "%s%u", bit ? ", " : "", p.bits[bit]);
+        }
+        fprintf(f, "};\n");
+    }
+    fprintf(f, "\n");
+    fprintf(f, "    static constexpr Port ports[] = {\n");
+    for (const auto& p : n.ports()) {
+        fprintf(f, "        {\"%s\", port_%s, %zu},\n", p.name.c_str(), p.name.c_str(), p.bits.size());
+    }
+    fprintf(f, "    };\n");
+    if (!components.empty()) {
+        fprintf(f, "\n");
+    }
+    for (const auto& c : components) {
+        fprintf(f, "    static constexpr size_t nands_%s = %zu;\n", c.first.c_str(), c.second);
+    }
+    fprintf(f, "};\n");
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "netlist.h"
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Generate a standalone C++ simulator for netlist @c n.
+///
+/// The generated source defines:
+/// - struct State, holding the signals that must persist between steps;
+/// - State initial(), the recorded signal values;
+/// - void step(State&), evaluating every operation once as straight-line code;
+/// - get_<port>(const State&) for each port held in State, and set_<port>(State&, uint16_t) for each input port.
+///
+/// Signals without a writer are folded to constants, except the bits of the ports named in @c inputs.
+/// Signals that are written before they are read, and are not part of a port, become local variables.
+/// Operations whose results are never observed are omitted.
+void generate(const Netlist& n, const std::vector<std::string>& inputs, FILE* f);
+
+/// Generate netlist @c n as constant tables, so that a simulator can start without building any gates.
+///
+/// The generated source defines struct @c name, with static constexpr members:
+/// - signals, the number of signals, and initial[signals], the recorded signal values;
+/// - ops[], the operations in evaluation order;
+/// - port_<port>[] for each port, its signal indices, least significant first, and ports[], all ports by name;
+/// - nands_<component> for each of @c components, its number of NAND operations.
+void generate_tables(const Netlist& n, const std::string& name, const std::vector<std::pair<std::string, size_t>>& components, FILE* f);
@@ -0,0 +1,19 @@
+#include <cstdio>
+
+#include "computer_generated.cpp"
+
+int main()
+{
+    State s = initial();
+
+    while (!get_halt(s)) {
+        // Show state.
+        printf("PC:%04x A:%04x D:%04x PA:%04x\n", get_pc(s), get_a(s), get_d(s), get_pa(s));
+
+        // Clock pulse.
+        set_clk(s, 1);
+        step(s);
+        set_clk(s, 0);
+        step(s);
+    }
+}
@@ -0,0 +1,24 @@
+#include <cstdio>
+
+#include "example.cpp"
+#include "fast.cpp"
+
+int main()
+{
+    std::vector<uint16_t> program = example_program();
+
+    Signal clk;
+    Signal halt;
+    FastComputer g{program, clk, halt};
+
+    while (!halt.get()) {
+        // Show state.
+        printf("PC:%04x A:%04x D:%04x PA:%04x\n", g.pc(), g.a(), g.d(), g.pa());
+
+        // Clock pulse.
+        clk.set(1);
+        g.update();
+        clk.set(0);
+        g.update();
+    }
+}
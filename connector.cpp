@@ -1,4 +1,5 @@
 #include "connector.h"
+#include "netlist.h"
 
 Connector::Connector(Signal& in, Signal& out) : in_{in}, out_{out}
 {
@@ -6,5 +7,10 @@ Connector::Connector(Signal& in, Signal& out) : in_{in}, out_{out}
 
 void Connector::update()
 {
+    if (Netlist::recording()) {
+        Netlist::recording()->connect(in_, out_);
+        return;
+    }
+
     out_.set(in_.get());
 }
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "gateif.h"
 #include "signal.h"
 
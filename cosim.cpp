@@ -0,0 +1,263 @@
+#pragma once
+
+#include "fast.cpp"
+#include "nand.cpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// @return Instruction @c instr in the notation of the instruction constants, e.g. "OP_DEC | DEST_D | COND_LT | COND_GT".
+static std::string disassemble(uint16_t instr)
+{
+    char buf[16];
+    if (!(instr & CI)) {
+        snprintf(buf, sizeof(buf), "0x%04x", instr);
+        return buf;
+    }
+    if (instr == HALT) {
+        return "HALT";
+    }
+
+    static const char* const ops[] = {"OP_AND", "OP_OR", "OP_XOR", "OP_NOT", "OP_ADD", "OP_SUB", "OP_INC", "OP_DEC"};
+    std::string s = ops[(instr >> 8) & 7];
+    auto flag = [&](uint16_t bits, const char* name)
+    {
+        if ((instr & bits) == bits) {
+            s += " | ";
+            s += name;
+        }
+    };
+    flag(HALT, "HALT");
+    flag(SM, "SM");
+    flag(ZX, "ZX");
+    flag(SW, "SW");
+    flag(DEST_A, "DEST_A");
+    flag(DEST_D, "DEST_D");
+    flag(DEST_PA, "DEST_PA");
+    if ((instr & ALWAYS) == ALWAYS) {
+        flag(ALWAYS, "ALWAYS");
+    } else {
+        flag(COND_LT, "COND_LT");
+        flag(COND_EQ, "COND_EQ");
+        flag(COND_GT, "COND_GT");
+    }
+    return s;
+}
+
+/// Co-simulation.
+/// Runs @c Model (e.g. the gate-level Computer, or one of its flattened engines) against the instruction-level
+/// @c Reference on the same program.
+/// Every @c interval cycles, on the last cycle of a run, and when the model halts, both are clocked and
+/// PC, A, D, *A, halt and RAM are compared; the run stops at the first difference.
+/// In between, if the model can load architectural state (see Computer::set_state()), only the reference is clocked,
+/// and its state is injected into the model before the next compared cycle: the model then costs one cycle in
+/// @c interval, and each check verifies one instruction of the model from the reference's state.
+/// Cycles that would halt the reference are always compared.
+/// A model without set_state() is clocked every cycle, in lockstep, and only the comparisons are skipped.
+/// A larger interval trades detection latency for speed: the instructions executed since the last
+/// successful check are kept, so the divergence can still be traced to them.
+template <typename Model, typename Reference = FastComputer>
+class Cosimulation
+{
+public:
+    /// First difference found.
+    struct Divergence
+    {
+        uint64_t cycle;
+        std::string what;
+        uint16_t model;
+        uint16_t reference;
+    };
+
+    /// Instruction executed by the model.
+    struct Step
+    {
+        uint64_t cycle;
+        uint16_t pc;
+        uint16_t instr;
+    };
+
+private:
+    template <typename M, typename = void>
+    struct Injectable : std::false_type
+    {
+    };
+
+    template <typename M>
+    struct Injectable<M, std::void_t<decltype(std::declval<M&>().set_state(std::declval<const ArchState&>()))>> : std::true_type
+    {
+    };
+
+    Signal clk_;
+    Signal model_halt_;
+    Signal reference_halt_;
+    Model model_;
+    Reference reference_;
+    unsigned interval_;
+    uint64_t cycles_;
+    uint64_t checks_;
+    bool behind_;
+    bool diverged_;
+    Divergence divergence_;
+    std::vector<Step> trace_;
+
+    /// Compare the models.
+    /// @return False on divergence.
+    bool check()
+    {
+        checks_++;
+
+        auto differ = [&](const std::string& what, uint16_t m, uint16_t r)
+        {
+            if (m != r) {
+                diverged_ = true;
+                divergence_ = Divergence{cycles_, what, m, r};
+            }
+            return m != r;
+        };
+
+        if (differ("pc", model_.pc(), reference_.pc()) ||
+            differ("a", model_.a(), reference_.a()) ||
+            differ("d", model_.d(), reference_.d()) ||
+            differ("pa", model_.pa(), reference_.pa()) ||
+            differ("halt", static_cast<uint16_t>(model_halt_.get()), static_cast<uint16_t>(reference_halt_.get()))) {
+            return false;
+        }
+        for (size_t address = 0; address < 16; ++address) {
+            if (differ("ram" + std::to_string(address), model_.ram(address), reference_.ram(address))) {
+                return false;
+            }
+        }
+
+        trace_.clear();
+        return true;
+    }
+
+public:
+    /// Co-simulate @c program, comparing every @c interval cycles (at least one).
+    Cosimulation(std::vector<uint16_t>& program, unsigned interval = 1) :
+        model_{program, clk_, model_halt_},
+        reference_{program, clk_, reference_halt_},
+        interval_{std::max(interval, 1u)},
+        cycles_{},
+        checks_{},
+        behind_{},
+        diverged_{},
+        divergence_{}
+    {
+    }
+
+    /// True if the model is clocked only on compared cycles.
+    static constexpr bool periodic = Injectable<Model>::value;
+
+    /// Run until the model halts, the models diverge, or at most @c cycles clock cycles.
+    /// @return False if the models diverged.
+    bool run(uint64_t cycles)
+    {
+        for (uint64_t i = 0; i < cycles && !diverged_ && !model_halt_.get(); ++i) {
+            bool compared = (cycles_ + 1) % interval_ == 0 || i + 1 == cycles;
+
+            if constexpr (periodic) {
+                uint16_t pc = reference_.pc();
+                uint16_t instr = reference_.rom(pc & 15);
+                if (!compared && !(instr & 0x4000)) {
+                    trace_.push_back(Step{cycles_, pc, instr});
+                    clk_.set(1);
+                    reference_.update();
+                    clk_.set(0);
+                    reference_.update();
+                    cycles_++;
+                    behind_ = true;
+                    continue;
+                }
+                if (behind_) {
+                    model_.set_state(reference_.state());
+                    behind_ = false;
+                }
+            }
+
+            uint16_t pc = model_.pc();
+            trace_.push_back(Step{cycles_, pc, model_.rom(pc & 15)});
+
+            clk_.set(1);
+            model_.update();
+            reference_.update();
+            clk_.set(0);
+            model_.update();
+            reference_.update();
+            cycles_++;
+
+            if ((compared || model_halt_.get()) && !check()) {
+                return false;
+            }
+        }
+        return !diverged_;
+    }
+
+    /// @return Number of clock cycles run.
+    uint64_t cycles() const
+    {
+        return cycles_;
+    }
+
+    /// @return Number of comparisons made.
+    uint64_t checks() const
+    {
+        return checks_;
+    }
+
+    /// @return True if the model has halted.
+    bool halted() const
+    {
+        return model_halt_.get();
+    }
+
+    /// @return True if the models diverged.
+    bool diverged() const
+    {
+        return diverged_;
+    }
+
+    /// @return First difference; only valid if diverged().
+    const Divergence& divergence() const
+    {
+        return divergence_;
+    }
+
+    /// @return Instructions executed since the last successful check, oldest first.
+    const std::vector<Step>& trace() const
+    {
+        return trace_;
+    }
+
+    const Model& model() const
+    {
+        return model_;
+    }
+
+    const Reference& reference() const
+    {
+        return reference_;
+    }
+
+    /// Print outcome, with the instructions executed since the last successful check on divergence.
+    void print(FILE* f) const
+    {
+        if (!diverged_) {
+            fprintf(f, "%s after %" PRIu64 " cycles, %" PRIu64 " checks\n", halted() ? "halted" : "running", cycles_, checks_);
+            return;
+        }
+
+        fprintf(f, "diverged by cycle %" PRIu64 ": %s model %04x reference %04x\n",
+            divergence_.cycle, divergence_.what.c_str(), divergence_.model, divergence_.reference);
+        for (const auto& step : trace_) {
+            fprintf(f, "  cycle %" PRIu64 " PC:%04x %04x %s\n", step.cycle, step.pc, step.instr, disassemble(step.instr).c_str());
+        }
+    }
+};
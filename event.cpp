@@ -0,0 +1,87 @@
+#include "event.h"
+
+EventInterpreter::EventInterpreter(const Netlist& n) :
+    ops_{n.ops()},
+    fanout_begin_(n.signals() + 1),
+    dirty_((ops_.size() + 63) / 64, ~uint64_t{}),
+    next_(dirty_.size()),
+    evaluated_{}
+{
+    // Initially every operation is scheduled.
+    if (ops_.size() % 64) {
+        dirty_.back() = (uint64_t{1} << (ops_.size() % 64)) - 1;
+    }
+
+    std::vector<uint8_t> written(n.signals());
+    for (const auto& op : ops_) {
+        fanout_begin_[op.a + 1]++;
+        if (op.b != op.a) {
+            fanout_begin_[op.b + 1]++;
+        }
+        written[op.out] = 1;
+    }
+
+    for (size_t s = 0; s < n.signals(); ++s) {
+        fanout_begin_[s + 1] += fanout_begin_[s];
+    }
+
+    fanout_.resize(fanout_begin_.back());
+    std::vector<uint32_t> fill{fanout_begin_.begin(), fanout_begin_.end() - 1};
+    for (size_t i = 0; i < ops_.size(); ++i) {
+        const auto& op = ops_[i];
+        fanout_[fill[op.a]++] = static_cast<uint32_t>(i);
+        if (op.b != op.a) {
+            fanout_[fill[op.b]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    for (size_t s = 0; s < n.signals(); ++s) {
+        if (!written[s]) {
+            inputs_.push_back(static_cast<uint32_t>(s));
+            seen_.push_back(n.initial()[s]);
+        }
+    }
+}
+
+void EventInterpreter::schedule(uint32_t signal, size_t current)
+{
+    for (uint32_t k = fanout_begin_[signal]; k < fanout_begin_[signal + 1]; ++k) {
+        uint32_t j = fanout_[k];
+        auto& bits = (j > current ? dirty_ : next_);
+        bits[j / 64] |= uint64_t{1} << (j % 64);
+    }
+}
+
+void EventInterpreter::evaluate(uint8_t* state)
+{
+    for (size_t w = 0; w < dirty_.size(); ++w) {
+        dirty_[w] |= next_[w];
+        next_[w] = 0;
+    }
+
+    for (size_t k = 0; k < inputs_.size(); ++k) {
+        if (state[inputs_[k]] != seen_[k]) {
+            seen_[k] = state[inputs_[k]];
+            // Every reader of an input is scheduled for this pass.
+            for (uint32_t f = fanout_begin_[inputs_[k]]; f < fanout_begin_[inputs_[k] + 1]; ++f) {
+                uint32_t j = fanout_[f];
+                dirty_[j / 64] |= uint64_t{1} << (j % 64);
+            }
+        }
+    }
+
+    for (size_t w = 0; w < dirty_.size(); ++w) {
+        while (dirty_[w]) {
+            size_t i = w * 64 + static_cast<size_t>(__builtin_ctzll(dirty_[w]));
+            dirty_[w] &= dirty_[w] - 1;
+
+            const auto& op = ops_[i];
+            auto value = Netlist::apply(op.code, state[op.a], state[op.b]);
+            evaluated_++;
+            if (value != state[op.out]) {
+                state[op.out] = value;
+                schedule(op.out, i);
+            }
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "netlist.h"
+
+#include <cstdint>
+#include <vector>
+
+/// Event-driven interpreter for a netlist.
+/// Only operations whose inputs changed since they were last evaluated are evaluated again.
+/// Results are identical to Interpreter: a change seen by a later operation is evaluated in the same pass,
+/// and a change seen by an earlier operation (feedback) is evaluated in the next pass.
+/// Signals without a writer (inputs) may be changed between passes and are checked for changes at the start of each pass.
+class EventInterpreter
+{
+    std::vector<Netlist::Op> ops_;
+
+    /// Operations reading signal s are fanout_[fanout_begin_[s] .. fanout_begin_[s + 1]).
+    std::vector<uint32_t> fanout_begin_;
+    std::vector<uint32_t> fanout_;
+
+    /// Signals without a writer, and their values as last seen.
+    std::vector<uint32_t> inputs_;
+    std::vector<uint8_t> seen_;
+
+    /// One bit per operation: scheduled for this pass, and for the next pass.
+    std::vector<uint64_t> dirty_;
+    std::vector<uint64_t> next_;
+
+    size_t evaluated_;
+
+    void schedule(uint32_t signal, size_t current);
+
+public:
+    explicit EventInterpreter(const Netlist& n);
+
+    /// Evaluate scheduled operations once, in order.
+    void evaluate(uint8_t* state);
+
+    /// @return Number of operations evaluated so far.
+    size_t evaluated() const
+    {
+        return evaluated_;
+    }
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "nand.cpp"
+
+#include <cstdint>
+#include <vector>
+
+/// Example program: count down from four, then halt.
+static std::vector<uint16_t> example_program()
+{
+    return {
+        /*00*/ 0x0004,
+        /*01*/ OP_ADD | ZX | DEST_D, // D = A
+        /*02*/ 0x0003,
+        /*03*/ OP_DEC | DEST_D | COND_LT | COND_GT, // D--; JNE A
+        /*04*/ HALT,
+        /*05*/ HALT,
+        /*06*/ HALT,
+        /*07*/ HALT,
+        /*08*/ HALT,
+        /*09*/ HALT,
+        /*0a*/ HALT,
+        /*0b*/ HALT,
+        /*0c*/ HALT,
+        /*0d*/ HALT,
+        /*0e*/ HALT,
+        /*0f*/ HALT,
+    };
+}
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "nand.cpp"
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/// Behavioral computer.
+/// Executes the instruction format documented at Computer directly with integer arithmetic, instead of gates.
+/// Behaves exactly as Computer at each update():
+/// when @c clk is high, the next state is computed from the current state and stored;
+/// when @c clk is low, the stored state is output.
+/// @c halt reflects the halt bit of the instruction at the PC at the start of the update.
+class FastComputer : public Gate
+{
+    Signal& clk_;
+    Signal& halt_;
+
+    std::array<uint16_t, 16> rom_;
+    std::array<uint16_t, 16> ram_;
+
+    uint16_t pc_;
+    uint16_t a_;
+    uint16_t d_;
+
+    /// State stored while @c clk is high, output when it is low.
+    uint16_t next_pc_;
+    uint16_t next_a_;
+    uint16_t next_d_;
+    bool write_;
+    uint16_t write_address_;
+    uint16_t write_value_;
+
+    /// Execute instruction @c instr: update @c pc, @c a and @c d, reading RAM @c ram.
+    /// @return True if @c r is to be written to RAM at the previous value of @c a.
+    static bool execute(uint16_t instr, uint16_t& pc, uint16_t& a, uint16_t& d, const uint16_t* ram, uint16_t& r)
+    {
+        if (!(instr & CI)) {
+            pc++;
+            a = instr;
+            return false;
+        }
+
+        uint16_t x = d;
+        uint16_t y = (instr & 0x1000) ? ram[a & 15] : a;
+        if (instr & 0x0040) {
+            std::swap(x, y);
+        }
+        if (instr & 0x0080) {
+            x = 0;
+        }
+
+        switch ((instr >> 8) & 7) {
+        case 0: r = x & y; break;
+        case 1: r = x | y; break;
+        case 2: r = x ^ y; break;
+        case 3: r = ~x; break;
+        case 4: r = x + y; break;
+        case 5: r = x - y; break;
+        case 6: r = x + 1; break;
+        case 7: r = x - 1; break;
+        }
+
+        bool lt = r & 0x8000;
+        bool eq = r == 0;
+        bool gt = !lt && !eq;
+        if (((instr & 0x0004) && lt) || ((instr & 0x0002) && eq) || ((instr & 0x0001) && gt)) {
+            pc = a;
+        } else {
+            pc++;
+        }
+        if (instr & 0x0020) {
+            a = r;
+        }
+        if (instr & 0x0010) {
+            d = r;
+        }
+        return instr & 0x0008;
+    }
+
+    /// Compute the next state from the current state.
+    void latch()
+    {
+        next_pc_ = pc_;
+        next_a_ = a_;
+        next_d_ = d_;
+        write_address_ = a_ & 15;
+        write_ = execute(rom_[pc_ & 15], next_pc_, next_a_, next_d_, ram_.data(), write_value_);
+    }
+
+    /// Output the stored state.
+    void commit()
+    {
+        pc_ = next_pc_;
+        a_ = next_a_;
+        d_ = next_d_;
+        if (write_) {
+            ram_[write_address_] = write_value_;
+        }
+    }
+
+public:
+    FastComputer(std::vector<uint16_t>& program, Signal& clk, Signal& halt) :
+        clk_{clk},
+        halt_{halt},
+        rom_{},
+        ram_{},
+        pc_{},
+        a_{},
+        d_{},
+        next_pc_{},
+        next_a_{},
+        next_d_{},
+        write_{},
+        write_address_{},
+        write_value_{}
+    {
+        for (size_t address = 0; address < 16; ++address) {
+            rom_[address] = program[address];
+        }
+    }
+
+    uint16_t pc() const
+    {
+        return pc_;
+    }
+
+    uint16_t a() const
+    {
+        return a_;
+    }
+
+    uint16_t d() const
+    {
+        return d_;
+    }
+
+    uint16_t pa() const
+    {
+        return ram_[a_ & 15];
+    }
+
+    /// @return RAM contents at @c address.
+    uint16_t ram(size_t address) const
+    {
+        return ram_[address];
+    }
+
+    /// @return ROM contents at @c address.
+    uint16_t rom(size_t address) const
+    {
+        return rom_[address];
+    }
+
+    /// @return Architectural state.
+    ArchState state() const
+    {
+        return ArchState{pc_, a_, d_, ram_};
+    }
+
+    /// Load architectural state @c s, as between clock cycles.
+    /// The halt signal is left unchanged until the next update.
+    void set_state(const ArchState& s)
+    {
+        pc_ = next_pc_ = s.pc;
+        a_ = next_a_ = s.a;
+        d_ = next_d_ = s.d;
+        ram_ = s.ram;
+        write_ = false;
+    }
+
+    /// Perform one whole clock cycle, as update() with @c clk high and then low.
+    /// @return Halt bit of the executed instruction.
+    bool step()
+    {
+        bool halt = rom_[pc_ & 15] & 0x4000;
+        latch();
+        commit();
+        halt_.set(halt);
+        return halt;
+    }
+
+    /// Perform clock cycles until halt, or at most @c cycles.
+    /// @return Number of cycles performed.
+    uint64_t run(uint64_t cycles)
+    {
+        // The registers are kept in locals: stores to RAM or to the halt signal could alias members.
+        uint16_t pc = pc_;
+        uint16_t a = a_;
+        uint16_t d = d_;
+        uint64_t i{};
+        bool halt{};
+        while (i < cycles && !halt) {
+            uint16_t instr = rom_[pc & 15];
+            uint16_t address = a & 15;
+            uint16_t r;
+            if (execute(instr, pc, a, d, ram_.data(), r)) {
+                ram_[address] = r;
+            }
+            halt = instr & 0x4000;
+            ++i;
+        }
+        pc_ = next_pc_ = pc;
+        a_ = next_a_ = a;
+        d_ = next_d_ = d;
+        write_ = false;
+        if (i) {
+            halt_.set(halt);
+        }
+        return i;
+    }
+
+    void update() override
+    {
+        halt_.set((rom_[pc_ & 15] >> 14) & 1);
+        if (clk_.get()) {
+            latch();
+        } else {
+            commit();
+        }
+    }
+};
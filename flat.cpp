@@ -0,0 +1,405 @@
+#pragma once
+
+#include "event.h"
+#include "interpreter.h"
+#include "jit.h"
+#include "levelize.h"
+#include "nand.cpp"
+#include "netlist.h"
+#include "optimize.h"
+#include "partition.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// Flatten a temporary Computer.
+/// Ports: pc, a, d, pa, rom0..rom15, ram0..ram15, clk and halt.
+static Netlist flatten(std::vector<uint16_t>& program, Signal& clk, Signal& halt)
+{
+    Computer c{program, clk, halt};
+    Netlist n{c};
+    c.ports(n);
+    n.port("clk", clk);
+    n.port("halt", halt);
+    return n;
+}
+
+/// Optimize a flattened Computer.
+/// The clock is the only input: the program is folded into the netlist.
+static Netlist optimize(const Netlist& n)
+{
+    return Optimization{n, {"clk"}}.netlist();
+}
+
+/// Flattened computer.
+/// Behaves exactly as Computer, but each update() evaluates the flattened NAND netlist of a Computer using @c Engine.
+/// Signals are indices into one array of values, so a running computer is cloned by copying that array:
+/// clones share the netlist and the engine, which are not modified by simulation.
+template <typename Engine>
+class BasicFlatComputer : public Gate
+{
+    /// Netlist, engine and ports, shared by clones.
+    struct Design
+    {
+        Netlist netlist;
+        Engine engine;
+        uint32_t clk;
+        uint32_t halt;
+        const Netlist::Port& pc;
+        const Netlist::Port& a;
+        const Netlist::Port& d;
+        const Netlist::Port& pa;
+        std::vector<const Netlist::Port*> rom;
+        std::vector<const Netlist::Port*> ram;
+
+        explicit Design(Netlist n) :
+            netlist{std::move(n)},
+            engine{netlist},
+            clk{netlist.port("clk").bits[0]},
+            halt{netlist.port("halt").bits[0]},
+            pc{netlist.port("pc")},
+            a{netlist.port("a")},
+            d{netlist.port("d")},
+            pa{netlist.port("pa")}
+        {
+            for (size_t address = 0; address < 16; ++address) {
+                rom.push_back(&netlist.port("rom" + std::to_string(address)));
+                ram.push_back(&netlist.port("ram" + std::to_string(address)));
+            }
+        }
+    };
+
+    template <typename E, typename = void>
+    struct Stateless : std::false_type
+    {
+    };
+
+    template <typename E>
+    struct Stateless<E, std::void_t<decltype(std::declval<const E&>().evaluate(std::declval<uint8_t*>()))>> : std::true_type
+    {
+    };
+
+    Signal& clk_;
+    Signal& halt_;
+    std::shared_ptr<Design> design_;
+    std::vector<uint8_t> state_;
+
+    uint16_t getint(const Netlist::Port& p) const
+    {
+        uint16_t x{};
+        unsigned shift{};
+        for (auto i : p.bits) {
+            x = static_cast<uint16_t>(x | (state_[i] << shift));
+            shift++;
+        }
+        return x;
+    }
+
+public:
+    /// True if the engine holds no state of its own (its evaluate() is const), so that clones can share it.
+    static constexpr bool clonable = Stateless<Engine>::value;
+
+    /// Construct from the flattened netlist @c n of a Computer, see flatten().
+    BasicFlatComputer(Netlist n, Signal& clk, Signal& halt) :
+        clk_{clk},
+        halt_{halt},
+        design_{std::make_shared<Design>(std::move(n))},
+        state_{design_->netlist.initial()}
+    {
+    }
+
+    BasicFlatComputer(std::vector<uint16_t>& program, Signal& clk, Signal& halt) :
+        BasicFlatComputer{flatten(program, clk, halt), clk, halt}
+    {
+    }
+
+    /// Clone of @c other, driven by @c clk and signalling @c halt, which continues from the same point,
+    /// e.g. to explore another branch from a given cycle.
+    BasicFlatComputer(const BasicFlatComputer& other, Signal& clk, Signal& halt) :
+        clk_{clk},
+        halt_{halt},
+        design_{other.design_},
+        state_{other.state_}
+    {
+        static_assert(clonable, "engine holds state, and cannot be shared");
+        halt_.set(state_[design_->halt]);
+    }
+
+    BasicFlatComputer(const BasicFlatComputer&) = delete;
+    BasicFlatComputer& operator=(const BasicFlatComputer&) = delete;
+
+    /// Return to the point of @c other, a clone of this computer or the computer it was cloned from.
+    /// Does not allocate.
+    void assign(const BasicFlatComputer& other)
+    {
+        static_assert(clonable, "engine holds state, and cannot be shared");
+        if (other.design_ != design_) {
+            throw std::invalid_argument("not a clone");
+        }
+        std::copy(other.state_.begin(), other.state_.end(), state_.begin());
+        halt_.set(state_[design_->halt]);
+    }
+
+    /// @return Flattened netlist.
+    const Netlist& netlist() const
+    {
+        return design_->netlist;
+    }
+
+    /// @return Engine.
+    const Engine& engine() const
+    {
+        return design_->engine;
+    }
+
+    uint16_t pc() const
+    {
+        return getint(design_->pc);
+    }
+
+    uint16_t a() const
+    {
+        return getint(design_->a);
+    }
+
+    uint16_t d() const
+    {
+        return getint(design_->d);
+    }
+
+    uint16_t pa() const
+    {
+        return getint(design_->pa);
+    }
+
+    /// @return RAM contents at @c address.
+    uint16_t ram(size_t address) const
+    {
+        return getint(*design_->ram[address]);
+    }
+
+    /// @return ROM contents at @c address.
+    uint16_t rom(size_t address) const
+    {
+        return getint(*design_->rom[address]);
+    }
+
+    void update() override
+    {
+        state_[design_->clk] = static_cast<uint8_t>(clk_.get());
+        design_->engine.evaluate(state_.data());
+        halt_.set(state_[design_->halt]);
+    }
+};
+
+/// Evaluates every operation on every update.
+typedef BasicFlatComputer<Interpreter> FlatComputer;
+
+/// Evaluates only operations whose inputs changed.
+typedef BasicFlatComputer<EventInterpreter> EventComputer;
+
+/// Evaluates every operation on every update, in level order.
+typedef BasicFlatComputer<LevelizedInterpreter> LevelizedComputer;
+
+/// Evaluates every operation on every update, as native code where supported.
+typedef BasicFlatComputer<Jit> JitComputer;
+
+/// Evaluates every operation on every update, split over one thread per core.
+typedef BasicFlatComputer<PartitionedInterpreter> PartitionedComputer;
+
+/// Evaluates every operation of the optimized netlist on every update.
+class OptimizedComputer : public FlatComputer
+{
+public:
+    OptimizedComputer(std::vector<uint16_t>& program, Signal& clk, Signal& halt) :
+        FlatComputer{optimize(flatten(program, clk, halt)), clk, halt}
+    {
+    }
+};
+
+/// Bit-sliced computer.
+/// Simulates 64 * @c WORDS independent computers, each with its own program, sharing one clock.
+/// Every signal of the flattened netlist is @c WORDS 64-bit words with one bit (lane) per computer,
+/// so one pass over the netlist advances all lanes; wide states use AVX2 or AVX-512 where available.
+/// A lane whose halt signal is set at the start of a cycle no longer sees the clock,
+/// so it stops where a Computer run until halt would stop, and its halt signal is held.
+/// Lanes without a program never see the clock.
+template <size_t WORDS>
+class BasicSlicedComputer : public Gate
+{
+public:
+    static const size_t LANES = 64 * WORDS;
+
+private:
+    Signal& clk_;
+    Signal halt_;
+    Netlist netlist_;
+    Interpreter interpreter_;
+    Interpreter::Isa isa_;
+    std::vector<uint64_t> active_;
+    std::vector<uint64_t> halted_;
+    std::vector<uint64_t> state_;
+    uint32_t clk_index_;
+    uint32_t halt_index_;
+    const Netlist::Port& pc_;
+    const Netlist::Port& a_;
+    const Netlist::Port& d_;
+    const Netlist::Port& pa_;
+    std::vector<const Netlist::Port*> rom_;
+    std::vector<const Netlist::Port*> ram_;
+
+    uint16_t getint(const Netlist::Port& p, size_t lane) const
+    {
+        uint16_t x{};
+        unsigned shift{};
+        for (auto i : p.bits) {
+            x = static_cast<uint16_t>(x | (((state_[i * WORDS + lane / 64] >> (lane % 64)) & 1) << shift));
+            shift++;
+        }
+        return x;
+    }
+
+    /// @return First of @c programs, which are checked.
+    /// @throws std::invalid_argument if there are none or more than LANES, or any has fewer than 16 words.
+    static std::vector<uint16_t>& first(std::vector<std::vector<uint16_t>>& programs)
+    {
+        if (programs.empty() || programs.size() > LANES) {
+            throw std::invalid_argument("bad number of programs: " + std::to_string(programs.size()));
+        }
+        for (const auto& program : programs) {
+            if (program.size() < 16) {
+                throw std::invalid_argument("bad program size: " + std::to_string(program.size()));
+            }
+        }
+        return programs[0];
+    }
+
+public:
+    /// Construct with 1 to @c LANES programs of (at least) 16 words.
+    /// @throws std::invalid_argument otherwise.
+    BasicSlicedComputer(std::vector<std::vector<uint16_t>>& programs, Signal& clk) :
+        clk_{clk},
+        netlist_{flatten(first(programs), clk, halt_)},
+        interpreter_{netlist_},
+        isa_{Interpreter::best(WORDS)},
+        active_(WORDS),
+        halted_(WORDS),
+        clk_index_{netlist_.port("clk").bits[0]},
+        halt_index_{netlist_.port("halt").bits[0]},
+        pc_{netlist_.port("pc")},
+        a_{netlist_.port("a")},
+        d_{netlist_.port("d")},
+        pa_{netlist_.port("pa")}
+    {
+        for (auto value : netlist_.initial()) {
+            state_.insert(state_.end(), WORDS, value ? ~uint64_t{} : 0);
+        }
+
+        for (size_t address = 0; address < 16; ++address) {
+            const auto& word = netlist_.port("rom" + std::to_string(address));
+            rom_.push_back(&word);
+            ram_.push_back(&netlist_.port("ram" + std::to_string(address)));
+            for (size_t bit = 0; bit < 16; ++bit) {
+                for (size_t w = 0; w < WORDS; ++w) {
+                    uint64_t x{};
+                    for (size_t lane = 64 * w; lane < 64 * (w + 1) && lane < programs.size(); ++lane) {
+                        x |= static_cast<uint64_t>((programs[lane][address] >> bit) & 1) << (lane % 64);
+                        active_[w] |= uint64_t{1} << (lane % 64);
+                    }
+                    state_[word.bits[bit] * WORDS + w] = x;
+                }
+            }
+        }
+    }
+
+    /// @return Instruction set used.
+    Interpreter::Isa isa() const
+    {
+        return isa_;
+    }
+
+    /// Use instruction set @c isa.
+    /// @throws std::invalid_argument if it is not usable for WORDS words (see Interpreter::usable()).
+    void isa(Interpreter::Isa isa)
+    {
+        if (!Interpreter::usable(isa, WORDS)) {
+            throw std::invalid_argument(std::string{"instruction set not usable: "} + Interpreter::name(isa));
+        }
+        isa_ = isa;
+    }
+
+    uint16_t pc(size_t lane) const
+    {
+        return getint(pc_, lane);
+    }
+
+    uint16_t a(size_t lane) const
+    {
+        return getint(a_, lane);
+    }
+
+    uint16_t d(size_t lane) const
+    {
+        return getint(d_, lane);
+    }
+
+    uint16_t pa(size_t lane) const
+    {
+        return getint(pa_, lane);
+    }
+
+    /// @return RAM contents of @c lane at @c address.
+    uint16_t ram(size_t lane, size_t address) const
+    {
+        return getint(*ram_[address], lane);
+    }
+
+    /// @return ROM contents of @c lane at @c address.
+    uint16_t rom(size_t lane, size_t address) const
+    {
+        return getint(*rom_[address], lane);
+    }
+
+    /// @return Halt signal of lanes 64 * @c word .. 64 * @c word + 63, held once a lane has stopped.
+    uint64_t halt(size_t word = 0) const
+    {
+        return state_[halt_index_ * WORDS + word] | halted_[word];
+    }
+
+    /// @return True if every lane with a program has halted.
+    bool halted() const
+    {
+        for (size_t w = 0; w < WORDS; ++w) {
+            if (active_[w] & ~halt(w)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void update() override
+    {
+        for (size_t w = 0; w < WORDS; ++w) {
+            if (clk_.get()) {
+                halted_[w] |= halt(w);
+            }
+            state_[clk_index_ * WORDS + w] = clk_.get() ? active_[w] & ~halted_[w] : 0;
+        }
+        interpreter_.evaluate(state_.data(), WORDS, isa_);
+    }
+};
+
+/// 64 lanes.
+typedef BasicSlicedComputer<1> SlicedComputer;
+
+/// 256 lanes.
+typedef BasicSlicedComputer<4> SlicedComputer256;
+
+/// 512 lanes.
+typedef BasicSlicedComputer<8> SlicedComputer512;
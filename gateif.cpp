@@ -1,5 +1,21 @@
 #include "gateif.h"
 
+Gate::Observer* Gate::observer_{};
+
+Gate::Observer::~Observer()
+{
+}
+
+Gate::Gate()
+{
+    if (observer_) {
+        observer_->constructed(this);
+    }
+}
+
 Gate::~Gate()
 {
+    if (observer_) {
+        observer_->destroyed(this);
+    }
 }
@@ -1,11 +1,36 @@
+#pragma once
+
 /// Abstract gate interface.
 /// A gate transforms one or more inputs to one or more outputs.
 class Gate
 {
 public:
+    /// Observer of gate construction and destruction, for instrumentation (see Census).
+    class Observer
+    {
+    public:
+        virtual ~Observer();
+        virtual void constructed(Gate* g) = 0;
+        virtual void destroyed(Gate* g) = 0;
+    };
+
+private:
+    /// Observer, if any.
+    static Observer* observer_;
+
+public:
+    /// Constructor.
+    Gate();
+
     /// Destructor.
     virtual ~Gate();
 
+    /// Set observer of all gates constructed or destroyed from now on, or nullptr.
+    static void observe(Observer* observer)
+    {
+        observer_ = observer;
+    }
+
     /// Update output.
     virtual void update() = 0;
 };
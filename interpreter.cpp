@@ -0,0 +1,193 @@
+#include "interpreter.h"
+
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/// Operands of a wide evaluation.
+struct Wide
+{
+    const uint32_t* a;
+    const uint32_t* b;
+    const uint32_t* out;
+    const uint8_t* invert_in;
+    const uint8_t* invert_out;
+    size_t n;
+    uint64_t* state;
+    size_t words;
+};
+
+static void evaluate_scalar(const Wide& w)
+{
+    for (size_t i = 0; i < w.n; ++i) {
+        const uint64_t in = uint64_t{} - w.invert_in[i];
+        const uint64_t invert = uint64_t{} - w.invert_out[i];
+        const uint64_t* a = w.state + w.a[i] * w.words;
+        const uint64_t* b = w.state + w.b[i] * w.words;
+        uint64_t* out = w.state + w.out[i] * w.words;
+        for (size_t k = 0; k < w.words; ++k) {
+            out[k] = ((a[k] ^ in) & (b[k] ^ in)) ^ invert;
+        }
+    }
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2")))
+static void evaluate_avx2(const Wide& w)
+{
+    for (size_t i = 0; i < w.n; ++i) {
+        const __m256i in = _mm256_set1_epi64x(-static_cast<int64_t>(w.invert_in[i]));
+        const __m256i invert = _mm256_set1_epi64x(-static_cast<int64_t>(w.invert_out[i]));
+        const uint64_t* a = w.state + w.a[i] * w.words;
+        const uint64_t* b = w.state + w.b[i] * w.words;
+        uint64_t* out = w.state + w.out[i] * w.words;
+        for (size_t k = 0; k < w.words; k += 4) {
+            __m256i x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + k)), in);
+            __m256i y = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + k)), in);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + k), _mm256_xor_si256(_mm256_and_si256(x, y), invert));
+        }
+    }
+}
+
+__attribute__((target("avx512f")))
+static void evaluate_avx512(const Wide& w)
+{
+    for (size_t i = 0; i < w.n; ++i) {
+        const __m512i in = _mm512_set1_epi64(-static_cast<int64_t>(w.invert_in[i]));
+        const __m512i invert = _mm512_set1_epi64(-static_cast<int64_t>(w.invert_out[i]));
+        const uint64_t* a = w.state + w.a[i] * w.words;
+        const uint64_t* b = w.state + w.b[i] * w.words;
+        uint64_t* out = w.state + w.out[i] * w.words;
+        for (size_t k = 0; k < w.words; k += 8) {
+            __m512i x = _mm512_xor_si512(_mm512_loadu_si512(a + k), in);
+            __m512i y = _mm512_xor_si512(_mm512_loadu_si512(b + k), in);
+            _mm512_storeu_si512(out + k, _mm512_xor_si512(_mm512_and_si512(x, y), invert));
+        }
+    }
+}
+#endif
+
+Interpreter::Interpreter(const Netlist& n)
+{
+    for (const auto& op : n.ops()) {
+        a_.push_back(op.a);
+        b_.push_back(op.b);
+        out_.push_back(op.out);
+        invert_in_.push_back(op.code == Netlist::OR ? 1 : 0);
+        invert_out_.push_back(op.code == Netlist::NAND || op.code == Netlist::OR ? 1 : 0);
+    }
+}
+
+void Interpreter::evaluate(uint8_t* state) const
+{
+    const uint32_t* a = a_.data();
+    const uint32_t* b = b_.data();
+    const uint32_t* out = out_.data();
+    const uint8_t* invert_in = invert_in_.data();
+    const uint8_t* invert_out = invert_out_.data();
+    const size_t n = out_.size();
+
+    for (size_t i = 0; i < n; ++i) {
+        state[out[i]] = static_cast<uint8_t>(((state[a[i]] ^ invert_in[i]) & (state[b[i]] ^ invert_in[i])) ^ invert_out[i]);
+    }
+}
+
+void Interpreter::evaluate(uint64_t* state) const
+{
+    const uint32_t* a = a_.data();
+    const uint32_t* b = b_.data();
+    const uint32_t* out = out_.data();
+    const uint8_t* invert_in = invert_in_.data();
+    const uint8_t* invert_out = invert_out_.data();
+    const size_t n = out_.size();
+
+    for (size_t i = 0; i < n; ++i) {
+        const uint64_t in = uint64_t{} - invert_in[i];
+        state[out[i]] = ((state[a[i]] ^ in) & (state[b[i]] ^ in)) ^ (uint64_t{} - invert_out[i]);
+    }
+}
+
+void Interpreter::evaluate(uint64_t* state, size_t words, Isa isa) const
+{
+    if (!usable(isa, words)) {
+        throw std::invalid_argument(std::string{"instruction set not usable: "} + name(isa));
+    }
+
+    const Wide w{a_.data(), b_.data(), out_.data(), invert_in_.data(), invert_out_.data(), out_.size(), state, words};
+
+    switch (isa) {
+#if defined(__x86_64__)
+    case AVX512:
+        evaluate_avx512(w);
+        return;
+    case AVX2:
+        evaluate_avx2(w);
+        return;
+#endif
+    default:
+        break;
+    }
+
+    if (words == 1) {
+        evaluate(state);
+    } else {
+        evaluate_scalar(w);
+    }
+}
+
+Interpreter::Isa Interpreter::best(size_t words)
+{
+    for (auto isa : {AVX512, AVX2}) {
+        if (usable(isa, words)) {
+            return isa;
+        }
+    }
+    return SCALAR;
+}
+
+bool Interpreter::supported(Isa isa)
+{
+    switch (isa) {
+    case SCALAR:
+        return true;
+#if defined(__x86_64__)
+    case AVX2:
+        return __builtin_cpu_supports("avx2");
+    case AVX512:
+        return __builtin_cpu_supports("avx512f");
+#else
+    default:
+        break;
+#endif
+    }
+    return false;
+}
+
+bool Interpreter::usable(Isa isa, size_t words)
+{
+    switch (isa) {
+    case SCALAR:
+        return true;
+    case AVX2:
+        return words % 4 == 0 && supported(isa);
+    case AVX512:
+        return words % 8 == 0 && supported(isa);
+    }
+    return false;
+}
+
+const char* Interpreter::name(Isa isa)
+{
+    switch (isa) {
+    case SCALAR:
+        break;
+    case AVX2:
+        return "avx2";
+    case AVX512:
+        return "avx512";
+    }
+    return "scalar";
+}
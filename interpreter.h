@@ -0,0 +1,62 @@
+#pragma once
+
+#include "netlist.h"
+
+#include <cstdint>
+#include <vector>
+
+/// Structure-of-arrays interpreter for a netlist.
+/// Each operation is evaluated as out = ((a ^ invert_in) & (b ^ invert_in)) ^ invert_out,
+/// where a connector has b = a, NAND inverts the output, and OR (by De Morgan) inverts inputs and output.
+/// State is either one signal per byte, or bit-sliced with one independent simulation per bit (lane) of a word.
+/// Wide bit-sliced state gives each signal several consecutive words, evaluated with AVX2 or AVX-512 where available.
+class Interpreter
+{
+public:
+    /// Instruction set for wide state.
+    enum Isa
+    {
+        SCALAR,
+        AVX2,
+        AVX512
+    };
+
+private:
+    std::vector<uint32_t> a_;
+    std::vector<uint32_t> b_;
+    std::vector<uint32_t> out_;
+    std::vector<uint8_t> invert_in_;
+    std::vector<uint8_t> invert_out_;
+
+public:
+    explicit Interpreter(const Netlist& n);
+
+    /// Evaluate all operations once, in order.
+    void evaluate(uint8_t* state) const;
+
+    /// Evaluate all operations once, in order, for 64 lanes.
+    void evaluate(uint64_t* state) const;
+
+    /// Evaluate all operations once, in order, for 64 * @c words lanes.
+    /// Signal s is state[s * words] .. state[s * words + words - 1].
+    /// @throws std::invalid_argument if @c isa is not usable for @c words (see usable()).
+    void evaluate(uint64_t* state, size_t words, Isa isa) const;
+
+    /// Evaluate all operations once, in order, for 64 * @c words lanes, using the best instruction set.
+    void evaluate(uint64_t* state, size_t words) const
+    {
+        evaluate(state, words, best(words));
+    }
+
+    /// @return Best instruction set of this CPU for @c words words per signal.
+    static Isa best(size_t words);
+
+    /// @return True if this CPU supports @c isa.
+    static bool supported(Isa isa);
+
+    /// @return True if this CPU supports @c isa, and @c words is a multiple of its vector width in words.
+    static bool usable(Isa isa, size_t words);
+
+    /// @return Name of @c isa.
+    static const char* name(Isa isa);
+};
@@ -0,0 +1,81 @@
+#include "jit.h"
+
+#include <cstring>
+#include <sys/mman.h>
+
+std::vector<uint8_t> Jit::assemble(const Netlist& n)
+{
+    std::vector<uint8_t> code;
+
+    // Instruction with ModRM [rdi + disp32], register al/eax.
+    auto emit = [&](std::vector<uint8_t> opcode, uint32_t disp)
+    {
+        code.insert(code.end(), opcode.begin(), opcode.end());
+        code.push_back(0x87);
+        for (unsigned i = 0; i < 4; ++i) {
+            code.push_back(static_cast<uint8_t>(disp >> (8 * i)));
+        }
+    };
+
+    for (const auto& op : n.ops()) {
+        // movzx eax, byte [rdi + a]
+        emit({0x0f, 0xb6}, op.a);
+        switch (op.code) {
+        case Netlist::NAND:
+            // and al, byte [rdi + b]
+            emit({0x22}, op.b);
+            // xor al, 1
+            code.push_back(0x34);
+            code.push_back(0x01);
+            break;
+        case Netlist::CONNECT:
+            break;
+        case Netlist::AND:
+            // and al, byte [rdi + b]
+            emit({0x22}, op.b);
+            break;
+        case Netlist::OR:
+            // or al, byte [rdi + b]
+            emit({0x0a}, op.b);
+            break;
+        }
+        // mov byte [rdi + out], al
+        emit({0x88}, op.out);
+    }
+
+    // ret
+    code.push_back(0xc3);
+    return code;
+}
+
+Jit::Jit(const Netlist& n) :
+    code_{},
+    size_{},
+    function_{}
+{
+#if defined(__x86_64__)
+    auto code = assemble(n);
+    void* p = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p != MAP_FAILED) {
+        memcpy(p, code.data(), code.size());
+        if (mprotect(p, code.size(), PROT_READ | PROT_EXEC) == 0) {
+            code_ = p;
+            size_ = code.size();
+            function_ = reinterpret_cast<Function>(p);
+        } else {
+            munmap(p, code.size());
+        }
+    }
+#endif
+
+    if (!function_) {
+        interpreter_ = std::make_unique<Interpreter>(n);
+    }
+}
+
+Jit::~Jit()
+{
+    if (code_) {
+        munmap(code_, size_);
+    }
+}
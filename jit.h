@@ -0,0 +1,45 @@
+#pragma once
+
+#include "interpreter.h"
+#include "netlist.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// Just-in-time compiler for a netlist.
+/// On x86-64, translates the operations into machine code in an executable mapping, one short instruction sequence per operation.
+/// Elsewhere, or if executable memory is unavailable, falls back to Interpreter.
+class Jit
+{
+    typedef void (*Function)(uint8_t* state);
+
+    void* code_;
+    size_t size_;
+    Function function_;
+    std::unique_ptr<Interpreter> interpreter_;
+
+    static std::vector<uint8_t> assemble(const Netlist& n);
+
+public:
+    explicit Jit(const Netlist& n);
+    Jit(const Jit&) = delete;
+    Jit& operator=(const Jit&) = delete;
+    ~Jit();
+
+    /// @return True if running native code.
+    bool compiled() const
+    {
+        return function_ != nullptr;
+    }
+
+    /// Evaluate all operations once, in order.
+    void evaluate(uint8_t* state) const
+    {
+        if (function_) {
+            function_(state);
+        } else {
+            interpreter_->evaluate(state);
+        }
+    }
+};
@@ -0,0 +1,174 @@
+#include "levelize.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+Levelization::Levelization(const Netlist& n) :
+    ops_{n.ops()},
+    level_(ops_.size()),
+    depth_{}
+{
+    const auto count = static_cast<uint32_t>(ops_.size());
+
+    auto inputs = [](const Netlist::Op& op)
+    {
+        std::vector<uint32_t> v{op.a};
+        if (op.b != op.a) {
+            v.push_back(op.b);
+        }
+        return v;
+    };
+
+    // Connectivity: writer to reader.
+    std::vector<std::vector<uint32_t>> writers(n.signals());
+    for (uint32_t i = 0; i < count; ++i) {
+        writers[ops_[i].out].push_back(i);
+    }
+
+    std::vector<std::vector<uint32_t>> succ(count);
+    for (uint32_t r = 0; r < count; ++r) {
+        for (auto s : inputs(ops_[r])) {
+            for (auto w : writers[s]) {
+                succ[w].push_back(r);
+            }
+        }
+    }
+
+    // Strongly connected components (Tarjan), without recursion.
+    // Components are numbered in reverse topological order.
+    const uint32_t unvisited = ~uint32_t{};
+    std::vector<uint32_t> index(count, unvisited);
+    std::vector<uint32_t> low(count);
+    std::vector<uint32_t> comp(count);
+    std::vector<uint8_t> on_stack(count);
+    std::vector<uint32_t> stack;
+    std::vector<std::pair<uint32_t, size_t>> call;
+    uint32_t next_index{};
+    uint32_t components{};
+
+    for (uint32_t root = 0; root < count; ++root) {
+        if (index[root] != unvisited) {
+            continue;
+        }
+
+        index[root] = low[root] = next_index++;
+        stack.push_back(root);
+        on_stack[root] = 1;
+        call.push_back({root, 0});
+
+        while (!call.empty()) {
+            uint32_t v = call.back().first;
+            size_t k = call.back().second;
+
+            if (k < succ[v].size()) {
+                call.back().second++;
+                uint32_t w = succ[v][k];
+                if (index[w] == unvisited) {
+                    index[w] = low[w] = next_index++;
+                    stack.push_back(w);
+                    on_stack[w] = 1;
+                    call.push_back({w, 0});
+                } else if (on_stack[w]) {
+                    low[v] = std::min(low[v], index[w]);
+                }
+                continue;
+            }
+
+            if (low[v] == index[v]) {
+                uint32_t size{};
+                uint32_t x;
+                do {
+                    x = stack.back();
+                    stack.pop_back();
+                    on_stack[x] = 0;
+                    comp[x] = components;
+                    size++;
+                } while (x != v);
+
+                bool self = std::find(succ[v].begin(), succ[v].end(), v) != succ[v].end();
+                if (size > 1 || self) {
+                    loops_.push_back(size);
+                }
+                components++;
+            }
+
+            call.pop_back();
+            if (!call.empty()) {
+                uint32_t u = call.back().first;
+                low[u] = std::min(low[u], low[v]);
+            }
+        }
+    }
+
+    // Ordering constraints.
+    std::vector<std::vector<uint32_t>> pred(count);
+    for (uint32_t r = 0; r < count; ++r) {
+        for (auto s : inputs(ops_[r])) {
+            for (auto w : writers[s]) {
+                if (comp[w] != comp[r]) {
+                    pred[r].push_back(w);
+                    if (w > r) {
+                        misordered_.push_back(Read{r, s});
+                    }
+                } else if (w < r) {
+                    pred[r].push_back(w);
+                } else if (w > r) {
+                    // Feedback: the writer must follow the reader.
+                    pred[w].push_back(r);
+                }
+            }
+        }
+    }
+
+    // Topological order: components in topological order, recorded order within each component.
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t x, uint32_t y)
+    {
+        auto cx = components - comp[x];
+        auto cy = components - comp[y];
+        return cx != cy ? cx < cy : x < y;
+    });
+
+    for (auto i : order) {
+        uint32_t level{};
+        for (auto p : pred[i]) {
+            level = std::max(level, level_[p] + 1);
+        }
+        level_[i] = level;
+        depth_ = std::max(depth_, static_cast<size_t>(level) + 1);
+    }
+}
+
+std::vector<Netlist::Op> Levelization::schedule() const
+{
+    std::vector<uint32_t> order(ops_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t x, uint32_t y)
+    {
+        return level_[x] < level_[y];
+    });
+
+    std::vector<Netlist::Op> ops;
+    for (auto i : order) {
+        ops.push_back(ops_[i]);
+    }
+    return ops;
+}
+
+void Levelization::print(FILE* f) const
+{
+    size_t looped{};
+    for (auto size : loops_) {
+        looped += size;
+    }
+
+    fprintf(f, "operations: %zu\n", ops_.size());
+    fprintf(f, "levels: %zu\n", depth_);
+    fprintf(f, "feedback loops: %zu (%zu operations)\n", loops_.size(), looped);
+    fprintf(f, "misordered reads: %zu\n", misordered_.size());
+    for (const auto& r : misordered_) {
+        fprintf(f, "  operation %u reads signal %u before it is written\n", r.op, r.signal);
+    }
+}
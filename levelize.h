@@ -0,0 +1,88 @@
+#pragma once
+
+#include "interpreter.h"
+#include "netlist.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/// Levelization.
+/// Derives a topological level for every operation of a netlist from its connectivity,
+/// independently of the order in which update() bodies happen to evaluate their parts.
+///
+/// Operations are grouped into feedback loops (strongly connected components).
+/// Between loops, an operation is always placed after the writers of its inputs.
+/// Within a loop, the recorded order is kept: a read of a signal written later in the loop is feedback,
+/// i.e. it sees the value of the previous pass, and its writer is placed after it.
+///
+/// Evaluating operations in level order then gives the same result as the recorded order,
+/// except for misordered reads: a read of a signal, outside any loop, whose writer was recorded later.
+/// The recorded order needs more than one pass to settle these; the level order does not.
+class Levelization
+{
+public:
+    /// Read of @c signal by operation @c op.
+    struct Read
+    {
+        uint32_t op;
+        uint32_t signal;
+    };
+
+private:
+    std::vector<Netlist::Op> ops_;
+    std::vector<uint32_t> level_;
+    std::vector<uint32_t> loops_;
+    std::vector<Read> misordered_;
+    size_t depth_;
+
+public:
+    explicit Levelization(const Netlist& n);
+
+    /// @return Level of each operation, in recorded order.
+    const std::vector<uint32_t>& level() const
+    {
+        return level_;
+    }
+
+    /// @return Number of levels.
+    size_t depth() const
+    {
+        return depth_;
+    }
+
+    /// @return Number of operations in each feedback loop.
+    const std::vector<uint32_t>& loops() const
+    {
+        return loops_;
+    }
+
+    /// @return Reads that the recorded order evaluates before their writer, outside any feedback loop.
+    const std::vector<Read>& misordered() const
+    {
+        return misordered_;
+    }
+
+    /// @return Operations sorted by level (stable).
+    std::vector<Netlist::Op> schedule() const;
+
+    /// Print summary.
+    void print(FILE* f) const;
+};
+
+/// Interpreter evaluating operations in level order.
+class LevelizedInterpreter
+{
+    Interpreter interpreter_;
+
+public:
+    explicit LevelizedInterpreter(const Netlist& n) :
+        interpreter_{Netlist{n, Levelization{n}.schedule()}}
+    {
+    }
+
+    void evaluate(uint8_t* state) const
+    {
+        interpreter_.evaluate(state);
+    }
+};
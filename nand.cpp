@@ -1,16 +1,25 @@
+#pragma once
+
 #include "connector.h"
+#include "netlist.h"
 #include "signal.h"
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 typedef SignalN<16> Signal16;
 typedef SignalSetN<16> SignalSet16;
 
 /// The fundamental gate, upon which all others are built.
-class NandGate : public Gate
+class NandGate final : public Gate
 {
 public:
     Signal& a_;
@@ -26,11 +35,17 @@ public:
 
     void update() override
     {
-        out_.set(!(a_.get() && b_.get()));
+        if (Netlist::recording()) {
+            Netlist::recording()->nand(a_, b_, out_);
+            return;
+        }
+
+        // Without a branch, which inputs would mispredict.
+        out_.set(!(a_.get() & b_.get()));
     }
 };
 
-class NotGate : public Gate
+class NotGate final : public Gate
 {
     NandGate nand_;
 
@@ -50,7 +65,7 @@ public:
     }
 };
 
-class AndGate : public Gate
+class AndGate final : public Gate
 {
     Signal c_;
     NandGate nand_;
@@ -76,7 +91,7 @@ public:
 
 /// Or.
 /// OR = NAND(NAND(A,B), NAND(A,B)) = DeMorgan
-class OrGate : public Gate
+class OrGate final : public Gate
 {
     Signal aprime_;
     NotGate nota_;
@@ -100,7 +115,7 @@ public:
     }
 };
 
-class XorGate : public Gate
+class XorGate final : public Gate
 {
     Signal s1_;
     OrGate or_;
@@ -126,7 +141,7 @@ public:
 
 /// Select.
 /// Output A if SEL else B.
-class SelectGate : public Gate
+class SelectGate final : public Gate
 {
     Signal tmp1_;
     AndGate and1_;
@@ -158,137 +173,260 @@ public:
     }
 };
 
+/// Word-level evaluation of N-bit gate arrays.
+/// An N-bit gate whose signal sets are contiguous evaluates eight signals at a time as one 64-bit word operation
+/// (each signal is a byte holding 0 or 1), with the same result as its NAND gates, but without the internal signals.
+/// The NAND gates are always built: they are used when disabled (e.g. for verification),
+/// when a netlist is being recorded, and when a signal set is not contiguous.
+class WordLevel
+{
+public:
+    static inline bool enabled = true;
+
+    /// Bit 0 of each byte: the value 1 of eight signals.
+    static constexpr uint64_t ONES = 0x0101010101010101;
+
+    /// @return True if word-level evaluation applies.
+    static bool active()
+    {
+        return enabled && !Netlist::recording();
+    }
+
+    /// Set the N signals at @c out to op(a, b), where op is applied to eight signals per 64-bit word
+    /// and must keep each byte 0 or 1.
+    template <size_t N, typename Op>
+    static void apply(Signal* out, const Signal* a, const Signal* b, Op op)
+    {
+        size_t i{};
+        for (; i + 8 <= N; i += 8) {
+            uint64_t x;
+            uint64_t y;
+            memcpy(&x, a + i, sizeof x);
+            memcpy(&y, b + i, sizeof y);
+            uint64_t z = op(x, y);
+            memcpy(static_cast<void*>(out + i), &z, sizeof z);
+        }
+        for (; i < N; ++i) {
+            out[i].set(op(uint64_t{a[i].get()}, uint64_t{b[i].get()}) & 1);
+        }
+    }
+};
+
+template <typename G, typename F, size_t... I>
+static std::array<G, sizeof...(I)> make_array(F make, std::index_sequence<I...>)
+{
+    return {{make(I)...}};
+}
+
+/// @return Array of @c N gates (or other objects) constructed in place, element i by make(i).
+/// The elements need be neither copyable nor movable.
+template <typename G, size_t N, typename F>
+static std::array<G, N> make_array(F make)
+{
+    return make_array<G>(make, std::make_index_sequence<N>{});
+}
+
+/// @return Bit slices of 16 words: slice i holds bit i of each word.
+static std::array<Signal16, 16> transpose(std::array<SignalSet16, 16>& words)
+{
+    return make_array<Signal16, 16>([&](size_t bit)
+    {
+        Signal16 slice;
+        for (size_t i = 0; i < 16; ++i) {
+            slice.setptr(i, words[i].ptr(bit));
+        }
+        return slice;
+    });
+}
+
 template <size_t N>
-class NotNGate : public Gate
+class NotNGate final : public Gate
 {
-    std::vector<std::unique_ptr<NotGate>> n_;
+    std::array<NotGate, N> n_;
+    Signal* in_;
+    Signal* out_;
 
 public:
-    NotNGate(SignalN<N>& in, SignalN<N>& out)
+    NotNGate(SignalN<N>& in, SignalN<N>& out) :
+        n_{make_array<NotGate, N>([&](size_t i) { return NotGate{in.ref(i), out.ref(i)}; })},
+        in_{in.contiguous()},
+        out_{out.contiguous()}
     {
-        for (size_t i = 0; i < N; ++i) {
-            n_.push_back(std::make_unique<NotGate>(in.ref(i), out.ref(i)));
-        }
     }
 
     void update() override
     {
+        if (in_ && out_ && WordLevel::active()) {
+            WordLevel::apply<N>(out_, in_, in_, [](uint64_t x, uint64_t) { return x ^ WordLevel::ONES; });
+            return;
+        }
+
         for (auto& n : n_) {
-            n->update();
+            n.update();
         }
     }
 };
 
 template <size_t N>
-class AndNGate : public Gate
+class AndNGate final : public Gate
 {
-    std::vector<std::unique_ptr<AndGate>> g_;
+    std::array<AndGate, N> g_;
+    Signal* a_;
+    Signal* b_;
+    Signal* out_;
 
 public:
-    AndNGate(SignalN<N>& a, SignalN<N>& b, SignalN<N>& out)
+    AndNGate(SignalN<N>& a, SignalN<N>& b, SignalN<N>& out) :
+        g_{make_array<AndGate, N>([&](size_t i) { return AndGate{a.ref(i), b.ref(i), out.ref(i)}; })},
+        a_{a.contiguous()},
+        b_{b.contiguous()},
+        out_{out.contiguous()}
     {
-        for (size_t i = 0; i < N; ++i) {
-            g_.push_back(std::make_unique<AndGate>(a.ref(i), b.ref(i), out.ref(i)));
-        }
     }
 
     void update() override
     {
+        if (a_ && b_ && out_ && WordLevel::active()) {
+            WordLevel::apply<N>(out_, a_, b_, [](uint64_t x, uint64_t y) { return x & y; });
+            return;
+        }
+
         for (auto& g : g_) {
-            g->update();
+            g.update();
         }
     }
 };
 
 template <size_t N>
-class OrNGate : public Gate
+class OrNGate final : public Gate
 {
-    std::vector<std::unique_ptr<OrGate>> g_;
+    std::array<OrGate, N> g_;
+    Signal* a_;
+    Signal* b_;
+    Signal* out_;
 
 public:
-    OrNGate(SignalN<N>& a, SignalN<N>& b, SignalN<N>& out)
+    OrNGate(SignalN<N>& a, SignalN<N>& b, SignalN<N>& out) :
+        g_{make_array<OrGate, N>([&](size_t i) { return OrGate{a.ref(i), b.ref(i), out.ref(i)}; })},
+        a_{a.contiguous()},
+        b_{b.contiguous()},
+        out_{out.contiguous()}
     {
-        for (size_t i = 0; i < N; ++i) {
-            g_.push_back(std::make_unique<OrGate>(a.ref(i), b.ref(i), out.ref(i)));
-        }
     }
 
     void update() override
     {
+        if (a_ && b_ && out_ && WordLevel::active()) {
+            WordLevel::apply<N>(out_, a_, b_, [](uint64_t x, uint64_t y) { return x | y; });
+            return;
+        }
+
         for (auto& g : g_) {
-            g->update();
+            g.update();
         }
     }
 };
 
 template <size_t N>
-class XorNGate : public Gate
+class XorNGate final : public Gate
 {
-    std::vector<std::unique_ptr<XorGate>> g_;
+    std::array<XorGate, N> g_;
+    Signal* a_;
+    Signal* b_;
+    Signal* out_;
 
 public:
-    XorNGate(SignalN<N>& a, SignalN<N>& b, SignalN<N>& out)
+    XorNGate(SignalN<N>& a, SignalN<N>& b, SignalN<N>& out) :
+        g_{make_array<XorGate, N>([&](size_t i) { return XorGate{a.ref(i), b.ref(i), out.ref(i)}; })},
+        a_{a.contiguous()},
+        b_{b.contiguous()},
+        out_{out.contiguous()}
     {
-        for (size_t i = 0; i < N; ++i) {
-            g_.push_back(std::make_unique<XorGate>(a.ref(i), b.ref(i), out.ref(i)));
-        }
     }
 
     void update() override
     {
+        if (a_ && b_ && out_ && WordLevel::active()) {
+            WordLevel::apply<N>(out_, a_, b_, [](uint64_t x, uint64_t y) { return x ^ y; });
+            return;
+        }
+
         for (auto& g : g_) {
-            g->update();
+            g.update();
         }
     }
 };
 
 /// Select.
-/// Output A if not SEL else B.
+/// Output A if SEL else B.
 template <size_t N>
-class SelectNGate : public Gate
+class SelectNGate final : public Gate
 {
-    std::vector<std::unique_ptr<SelectGate>> g_;
+    std::array<SelectGate, N> g_;
+    Signal& sel_;
+    Signal* a_;
+    Signal* b_;
+    Signal* out_;
 
 public:
-    SelectNGate(Signal& sel, SignalN<N>& a, SignalN<N>& b, SignalN<N>& out)
+    SelectNGate(Signal& sel, SignalN<N>& a, SignalN<N>& b, SignalN<N>& out) :
+        g_{make_array<SelectGate, N>([&](size_t i) { return SelectGate{sel, a.ref(i), b.ref(i), out.ref(i)}; })},
+        sel_{sel},
+        a_{a.contiguous()},
+        b_{b.contiguous()},
+        out_{out.contiguous()}
     {
-        for (size_t i = 0; i < N; ++i) {
-            g_.push_back(std::make_unique<SelectGate>(sel, a.ref(i), b.ref(i), out.ref(i)));
-        }
     }
 
     void update() override
     {
+        if (a_ && b_ && out_ && WordLevel::active()) {
+            // All ones if SEL, else zero.
+            uint64_t m = uint64_t{} - sel_.get();
+            WordLevel::apply<N>(out_, a_, b_, [m](uint64_t x, uint64_t y) { return (x & m) | (y & ~m); });
+            return;
+        }
+
         for (auto& g : g_) {
-            g->update();
+            g.update();
         }
     }
 };
 
 /// Mask N bits with single bit.
 template <size_t N>
-class Mask1xNGate : public Gate
+class Mask1xNGate final : public Gate
 {
-    std::vector<std::unique_ptr<AndGate>> g_;
+    std::array<AndGate, N> g_;
+    Signal& a_;
+    Signal* b_;
+    Signal* out_;
 
 public:
-    Mask1xNGate(Signal& a, SignalN<N>& b, SignalN<N>& out)
+    Mask1xNGate(Signal& a, SignalN<N>& b, SignalN<N>& out) :
+        g_{make_array<AndGate, N>([&](size_t i) { return AndGate{a, b.ref(i), out.ref(i)}; })},
+        a_{a},
+        b_{b.contiguous()},
+        out_{out.contiguous()}
     {
-        for (size_t i = 0; i < N; ++i) {
-            g_.push_back(std::make_unique<AndGate>(a, b.ref(i), out.ref(i)));
-        }
     }
 
 public:
     void update() override
     {
+        if (b_ && out_ && WordLevel::active()) {
+            uint64_t m = uint64_t{} - a_.get();
+            WordLevel::apply<N>(out_, b_, b_, [m](uint64_t x, uint64_t) { return x & m; });
+            return;
+        }
+
         for (auto& g : g_) {
-            g->update();
+            g.update();
         }
     }
 };
 
-class Reduce4Gate : public Gate
+class Reduce4Gate final : public Gate
 {
     Signal ab_;
     AndGate and1_;
@@ -312,7 +450,7 @@ public:
     }
 };
 
-class Combine16Gate : public Gate
+class Combine16Gate final : public Gate
 {
     Signal b01_;
     OrGate g01_;
@@ -393,7 +531,7 @@ public:
 
 /// Decoder.
 /// Takes a 4-bit address and outputs 16 lines, where only one is high at a time — the one corresponding to the binary value of the input.
-class Decoder4to16Gate : public Gate
+class Decoder4to16Gate final : public Gate
 {
     Signal n0_;
     Signal n1_;
@@ -473,33 +611,51 @@ public:
     }
 };
 
+/// Multiplexer with decoded address.
+/// out = in[i] where hot[i] is set, for one-hot @c hot.
+class OneHotMux16to1Gate final : public Gate
+{
+    SignalSet16 anded_;
+    AndNGate<16> mask_;
+    Combine16Gate combine_;
+
+public:
+    OneHotMux16to1Gate(Signal16& in, Signal16& hot, Signal& out) :
+        mask_{in, hot, anded_},
+        combine_{anded_, out}
+    {
+    }
+
+    void update() override
+    {
+        mask_.update();
+        combine_.update();
+    }
+};
+
 /// Multiplexer.
 /// out = in[ad]
-class Mux16to1Gate : public Gate
+class Mux16to1Gate final : public Gate
 {
     SignalSet16 hot_;
     Decoder4to16Gate decoder_;
-    SignalSet16 anded_;
-    AndNGate<16> mask_;
-    Combine16Gate combine_;
+    OneHotMux16to1Gate mux_;
 
 public:
     Mux16to1Gate(Signal16& in, Signal16& ad, Signal& out) :
         decoder_{ad, hot_},
-        mask_{in, hot_, anded_},
-        combine_{anded_, out}
+        mux_{in, hot_, out}
     {
     }
 
     void update() override
     {
         decoder_.update();
-        mask_.update();
-        combine_.update();
+        mux_.update();
     }
 };
 
-class DataLatchGate : public Gate
+class DataLatchGate final : public Gate
 {
     /// The initial output (before @c st is set for the first time) is unspecified.
     SelectGate mux_;
@@ -520,7 +676,7 @@ public:
 /// Inputs @c st and @c d may change when clock @c clk is low.
 /// When @c clk changes to high, then the current value of @c d is stored.
 /// When @c clk changes to low again, then the previously stored value is output.
-class DataFlipFlop : public Gate
+class DataFlipFlop final : public Gate
 {
     Signal tmp1_;
     AndGate and_;
@@ -529,14 +685,24 @@ class DataFlipFlop : public Gate
     Signal nclk_;
     NotGate not_;
     DataLatchGate l1_;
+    Signal& out_;
 
 public:
     DataFlipFlop(Signal& st, Signal& in, Signal& clk, Signal& out) :
         and_{st, clk, tmp1_},
         l2_{tmp1_, in, tmp2_},
         not_{clk, nclk_},
-        l1_{nclk_, tmp2_, out}
+        l1_{nclk_, tmp2_, out},
+        out_{out}
+    {
+    }
+
+    /// Store and output @c value without clocking, for simulation purposes.
+    /// Both latches hold @c value, as after a clock pulse with @c value as input.
+    void set(unsigned value)
     {
+        tmp2_.set(value);
+        out_.set(value);
     }
 
     ~DataFlipFlop() override
@@ -553,31 +719,37 @@ public:
 };
 
 // 16-bit register.
-class Register : public Gate
+class Register final : public Gate
 {
-    std::vector<std::unique_ptr<DataFlipFlop>> g_;
+    std::array<DataFlipFlop, 16> g_;
 
 public:
-    Register(Signal& st, Signal16& in, Signal& clk, Signal16& out)
+    Register(Signal& st, Signal16& in, Signal& clk, Signal16& out) :
+        g_{make_array<DataFlipFlop, 16>([&](size_t i) { return DataFlipFlop{st, in.ref(i), clk, out.ref(i)}; })}
     {
-        for (size_t i = 0; i < in.size(); ++i) {
-            g_.push_back(std::make_unique<DataFlipFlop>(st, in.ref(i), clk, out.ref(i)));
-        }
     }
 
     ~Register() override
     {
     }
 
+    /// Store and output @c x without clocking, for simulation purposes.
+    void set(uint16_t x)
+    {
+        for (size_t i = 0; i < g_.size(); ++i) {
+            g_[i].set((x >> i) & 1);
+        }
+    }
+
     void update() override
     {
         for (auto& g : g_) {
-            g->update();
+            g.update();
         }
     }
 };
 
-class HalfAdderGate : public Gate
+class HalfAdderGate final : public Gate
 {
     AndGate and_;
     XorGate xor_;
@@ -596,7 +768,7 @@ public:
     }
 };
 
-class FullAdderGate : public Gate
+class FullAdderGate final : public Gate
 {
     Signal h1_;
     Signal l1_;
@@ -621,7 +793,7 @@ public:
     }
 };
 
-class Add16Gate : public Gate
+class Add16Gate final : public Gate
 {
     Signal h0_;
     FullAdderGate f0_;
@@ -697,7 +869,7 @@ public:
     }
 };
 
-class Sub16Gate : public Gate
+class Sub16Gate final : public Gate
 {
     SignalSet16 b_inv_;
     NotNGate<16> inv_;
@@ -725,7 +897,7 @@ public:
     }
 };
 
-class Inc16Gate : public Gate
+class Inc16Gate final : public Gate
 {
     Signal zero_;
     Signal one_;
@@ -748,7 +920,15 @@ public:
     }
 };
 
-class Counter : public Gate
+/// Program counter, gate-level or behavioral.
+class CounterUnit : public Gate
+{
+public:
+    /// Store and output @c x without clocking, for simulation purposes.
+    virtual void set(uint16_t x) = 0;
+};
+
+class Counter final : public CounterUnit
 {
     Signal zero_;
     Signal one_;
@@ -768,6 +948,11 @@ public:
     {
     }
 
+    void set(uint16_t x) override
+    {
+        reg_.set(x);
+    }
+
     void update() override
     {
         nand_.update();
@@ -777,12 +962,80 @@ public:
     }
 };
 
+/// Block of Computer that is simulated behaviorally instead of by gates, see Computer.
+const unsigned BEHAVIORAL_ROM       = 0x01;
+const unsigned BEHAVIORAL_RAM       = 0x02;
+const unsigned BEHAVIORAL_ALU       = 0x04;
+const unsigned BEHAVIORAL_CONDITION = 0x08;
+const unsigned BEHAVIORAL_COUNTER   = 0x10;
+const unsigned BEHAVIORAL_ALL       = 0x1f;
+
+/// Base class of behavioral blocks.
+/// A behavioral block has the same port signals as its gate-level counterpart, and sets its outputs to the same values
+/// at each update(), but has no gates: it cannot be recorded into a Netlist.
+class Behavioral
+{
+protected:
+    static void check()
+    {
+        if (Netlist::recording()) {
+            throw std::logic_error("behavioral block cannot be recorded");
+        }
+    }
+};
+
+/// @return Behavioral block @c B if @c behavioral, else gate-level block @c G, constructed from @c args.
+template <typename Base, typename G, typename B, typename... Args>
+static std::unique_ptr<Base> make_block(bool behavioral, Args&&... args)
+{
+    if (behavioral) {
+        return std::make_unique<B>(std::forward<Args>(args)...);
+    }
+    return std::make_unique<G>(std::forward<Args>(args)...);
+}
+
+/// Behavioral Counter.
+class BehavioralCounter final : public CounterUnit, Behavioral
+{
+    Signal& sel_;
+    Signal16& x_;
+    Signal& clk_;
+    Signal16& out_;
+    uint16_t stored_;
+
+public:
+    BehavioralCounter(Signal& sel, Signal16& x, Signal& clk, Signal16& out) :
+        sel_{sel},
+        x_{x},
+        clk_{clk},
+        out_{out},
+        stored_{}
+    {
+    }
+
+    void set(uint16_t x) override
+    {
+        stored_ = x;
+        out_.setint(x);
+    }
+
+    void update() override
+    {
+        check();
+        if (clk_.get()) {
+            stored_ = sel_.get() ? x_.getint() : static_cast<uint16_t>(out_.getint() + 1);
+        } else {
+            out_.setint(stored_);
+        }
+    }
+};
+
 /// Logic Unit.
 /// 00 X&Y
 /// 01 X|Y
 /// 10 X^Y
 /// 11 ~X
-class LogicUnit : public Gate
+class LogicUnit final : public Gate
 {
     SignalSet16 s1_;
     AndNGate<16> and_;
@@ -833,7 +1086,7 @@ public:
 /// 01 X-Y
 /// 10 X+1
 /// 11 X-1
-class ArithmeticUnit : public Gate
+class ArithmeticUnit final : public Gate
 {
     SignalSet16 xy_add_;
     Signal c1_;
@@ -887,7 +1140,7 @@ public:
     }
 };
 
-class ArithmeticAndLogicUnit : public Gate
+class ArithmeticAndLogicUnit final : public Gate
 {
     SignalSet16 tmp_lhs_;
     SelectNGate<16> select_xy_;
@@ -934,7 +1187,59 @@ public:
     }
 };
 
-class IsZeroGate : public Gate
+/// Behavioral ArithmeticAndLogicUnit.
+class BehavioralArithmeticAndLogicUnit final : public Gate, Behavioral
+{
+    Signal& u_;
+    Signal& op1_;
+    Signal& op0_;
+    Signal& zx_;
+    Signal& sw_;
+    Signal16& x_;
+    Signal16& y_;
+    Signal16& out_;
+
+public:
+    BehavioralArithmeticAndLogicUnit(Signal& u, Signal& op1, Signal& op0, Signal& zx, Signal& sw, Signal16& x, Signal16& y, Signal16& out) :
+        u_{u},
+        op1_{op1},
+        op0_{op0},
+        zx_{zx},
+        sw_{sw},
+        x_{x},
+        y_{y},
+        out_{out}
+    {
+    }
+
+    void update() override
+    {
+        check();
+        uint16_t x = x_.getint();
+        uint16_t y = y_.getint();
+        if (sw_.get()) {
+            std::swap(x, y);
+        }
+        if (zx_.get()) {
+            x = 0;
+        }
+
+        uint16_t r{};
+        switch (u_.get() << 2 | op1_.get() << 1 | op0_.get()) {
+        case 0: r = x & y; break;
+        case 1: r = x | y; break;
+        case 2: r = x ^ y; break;
+        case 3: r = ~x; break;
+        case 4: r = x + y; break;
+        case 5: r = x - y; break;
+        case 6: r = x + 1; break;
+        case 7: r = x - 1; break;
+        }
+        out_.setint(r);
+    }
+};
+
+class IsZeroGate final : public Gate
 {
     Signal combined_;
     Combine16Gate combine_;
@@ -954,7 +1259,7 @@ public:
     }
 };
 
-class IsNegativeGate : public Gate
+class IsNegativeGate final : public Gate
 {
     Connector connect_;
 
@@ -981,7 +1286,7 @@ public:
 ///  1  0  1  X ≠ 0
 ///  1  1  0  X ≤ 0
 ///  1  1  1  always
-class ConditionUnit : public Gate
+class ConditionUnit final : public Gate
 {
     Signal is_lt_;
     IsNegativeGate lt_gate_;
@@ -1041,6 +1346,36 @@ public:
     }
 };
 
+/// Behavioral ConditionUnit.
+class BehavioralConditionUnit final : public Gate, Behavioral
+{
+    Signal& lt_;
+    Signal& eq_;
+    Signal& gt_;
+    Signal16& x_;
+    Signal& out_;
+
+public:
+    BehavioralConditionUnit(Signal& lt, Signal& eq, Signal& gt, Signal16& x, Signal& out) :
+        lt_{lt},
+        eq_{eq},
+        gt_{gt},
+        x_{x},
+        out_{out}
+    {
+    }
+
+    void update() override
+    {
+        check();
+        uint16_t x = x_.getint();
+        bool is_lt = x & 0x8000;
+        bool is_eq = x == 0;
+        bool is_gt = !is_lt && !is_eq;
+        out_.set((lt_.get() && is_lt) || (eq_.get() && is_eq) || (gt_.get() && is_gt));
+    }
+};
+
 /*
  * Machine based on https://nandgame.com
  * (Retrieved 2024-05-03.)
@@ -1109,21 +1444,23 @@ const uint16_t COND_EQ  = (CI | 0x0002);
 const uint16_t COND_GT  = (CI | 0x0001);
 const uint16_t ALWAYS   = (CI | 0x0007);
 
-class AluInstruction : public Gate
+class AluInstruction final : public Gate
 {
     SignalSet16 y_;
     SelectNGate<16> select_;
-    ArithmeticAndLogicUnit alu_;
-    ConditionUnit cond_;
+    std::unique_ptr<Gate> alu_;
+    std::unique_ptr<Gate> cond_;
     Connector connect_sel_a_;
     Connector connect_sel_d_;
     Connector connect_sel_pa_;
 
 public:
-    AluInstruction(Signal16& instr, Signal16& a, Signal16& d, Signal16& pa, Signal16& r, Signal& sel_a, Signal& sel_d, Signal& sel_pa, Signal& j) :
+    AluInstruction(Signal16& instr, Signal16& a, Signal16& d, Signal16& pa, Signal16& r, Signal& sel_a, Signal& sel_d, Signal& sel_pa, Signal& j, unsigned behavioral = 0) :
         select_{instr.ref(12), pa, a, y_},
-        alu_{instr.ref(10), instr.ref(9), instr.ref(8), instr.ref(7), instr.ref(6), d, y_, r},
-        cond_{instr.ref(2), instr.ref(1), instr.ref(0), r, j},
+        alu_{make_block<Gate, ArithmeticAndLogicUnit, BehavioralArithmeticAndLogicUnit>(behavioral & BEHAVIORAL_ALU,
+            instr.ref(10), instr.ref(9), instr.ref(8), instr.ref(7), instr.ref(6), d, y_, r)},
+        cond_{make_block<Gate, ConditionUnit, BehavioralConditionUnit>(behavioral & BEHAVIORAL_CONDITION,
+            instr.ref(2), instr.ref(1), instr.ref(0), r, j)},
         connect_sel_a_{instr.ref(5), sel_a},
         connect_sel_d_{instr.ref(4), sel_d},
         connect_sel_pa_{instr.ref(3), sel_pa}
@@ -1133,15 +1470,15 @@ public:
     void update() override
     {
         select_.update();
-        alu_.update();
-        cond_.update();
+        alu_->update();
+        cond_->update();
         connect_sel_a_.update();
         connect_sel_d_.update();
         connect_sel_pa_.update();
     }
 };
 
-class ControlSelectorGate : public Gate
+class ControlSelectorGate final : public Gate
 {
     SelectNGate<16> choose_r_;
     SelectGate choose_a_;
@@ -1169,7 +1506,7 @@ public:
     }
 };
 
-class ControlUnit : public Gate
+class ControlUnit final : public Gate
 {
     SignalSet16 r1_;
     Signal sel_a1_;
@@ -1185,8 +1522,8 @@ class ControlUnit : public Gate
     ControlSelectorGate selector_;
 
 public:
-    ControlUnit(Signal16& instr, Signal16& a, Signal16& d, Signal16& pa, Signal16& r, Signal& sel_a, Signal& sel_d, Signal& sel_pa, Signal& j) :
-        alu_{instr, a, d, pa, r1_, sel_a1_, sel_d1_, sel_pa1_, sel_j1_},
+    ControlUnit(Signal16& instr, Signal16& a, Signal16& d, Signal16& pa, Signal16& r, Signal& sel_a, Signal& sel_d, Signal& sel_pa, Signal& j, unsigned behavioral = 0) :
+        alu_{instr, a, d, pa, r1_, sel_a1_, sel_d1_, sel_pa1_, sel_j1_, behavioral},
 
         nand_{zero_, zero_, one_},
 
@@ -1202,125 +1539,290 @@ public:
     }
 };
 
-class Ram16x16 : public Gate
+/// RAM, gate-level or behavioral.
+class RamUnit : public Gate
+{
+public:
+    /// @return Contents of register @c address, for simulation purposes.
+    virtual uint16_t word(size_t address) const = 0;
+
+    /// Store @c x in register @c address without clocking, for simulation purposes.
+    virtual void set(size_t address, uint16_t x) = 0;
+
+    /// Name ports of flattened netlist.
+    virtual void ports(Netlist& n) = 0;
+};
+
+class Ram16x16 final : public RamUnit
 {
     SignalSet16 hot_;
     Decoder4to16Gate decoder_;
     SignalSet16 select_;
     Mask1xNGate<16> mask_;
-    std::vector<std::unique_ptr<SignalSet16>> rout_;
-    std::vector<std::unique_ptr<Gate>> gates_;
-    std::vector<std::unique_ptr<Signal16>> slices_;
+    std::array<SignalSet16, 16> rout_;
+    std::array<Register, 16> registers_;
+    std::array<Signal16, 16> slices_;
+    std::array<OneHotMux16to1Gate, 16> gates_;
 
 public:
     Ram16x16(Signal& st, Signal16& x, Signal16& ad, Signal& clk, Signal16& out) :
         decoder_{ad, hot_},
-        mask_{st, hot_, select_}
-    {
+        mask_{st, hot_, select_},
         // 16 registers of 16-bits.
-        for (size_t reg = 0; reg < 16; ++reg) {
-            auto tmp = std::make_unique<SignalSet16>();
-            gates_.push_back(std::make_unique<Register>(select_.ref(reg), x, clk, *tmp));
-            rout_.push_back(std::move(tmp));
-        }
-
-        // For each bit, an instance of Mux16to1Gate is used to select the register-specific bit.
-        for (size_t bit = 0; bit < 16; ++bit) {
-            auto slice = std::make_unique<Signal16>();
-            for (size_t reg = 0; reg < 16; ++reg) {
-                slice->setptr(reg, rout_[reg]->ptr(bit));
-            }
-            gates_.push_back(std::make_unique<Mux16to1Gate>(*slice, ad, out.ref(bit)));
-            slices_.push_back(std::move(slice));
-        }
+        registers_{make_array<Register, 16>([&](size_t reg) { return Register{select_.ref(reg), x, clk, rout_[reg]}; })},
+        // For each bit, an instance of OneHotMux16to1Gate is used to select the register-specific bit.
+        // All share the address decoder.
+        slices_{transpose(rout_)},
+        gates_{make_array<OneHotMux16to1Gate, 16>([&](size_t bit) { return OneHotMux16to1Gate{slices_[bit], hot_, out.ref(bit)}; })}
+    {
     }
 
     ~Ram16x16() override
     {
     }
 
+    uint16_t word(size_t address) const override
+    {
+        return rout_[address].getint();
+    }
+
+    void set(size_t address, uint16_t x) override
+    {
+        registers_[address].set(x);
+    }
+
+    void ports(Netlist& n) override
+    {
+        for (size_t address = 0; address < 16; ++address) {
+            n.port("ram" + std::to_string(address), rout_[address]);
+        }
+    }
+
     void update() override
     {
         decoder_.update();
         mask_.update();
+        for (auto& r : registers_) {
+            r.update();
+        }
         for (auto& g : gates_) {
-            g->update();
+            g.update();
+        }
+    }
+};
+
+/// Behavioral Ram16x16.
+class BehavioralRam16x16 final : public RamUnit, Behavioral
+{
+    Signal& st_;
+    Signal16& x_;
+    Signal16& ad_;
+    Signal& clk_;
+    Signal16& out_;
+    std::array<uint16_t, 16> stored_;
+    std::array<uint16_t, 16> words_;
+
+public:
+    BehavioralRam16x16(Signal& st, Signal16& x, Signal16& ad, Signal& clk, Signal16& out) :
+        st_{st},
+        x_{x},
+        ad_{ad},
+        clk_{clk},
+        out_{out},
+        stored_{},
+        words_{}
+    {
+    }
+
+    uint16_t word(size_t address) const override
+    {
+        return words_[address];
+    }
+
+    void set(size_t address, uint16_t x) override
+    {
+        stored_[address] = x;
+        words_[address] = x;
+    }
+
+    void ports(Netlist&) override
+    {
+        check();
+    }
+
+    void update() override
+    {
+        check();
+        size_t address = ad_.getint() & 15;
+        if (!clk_.get()) {
+            words_ = stored_;
+        } else if (st_.get()) {
+            stored_[address] = x_.getint();
         }
+        out_.setint(words_[address]);
     }
 };
 
 /// Combined memory unit.
 /// Two 16-bit registers called A and D, and a RAM unit.
-class CombinedMemoryUnit : public Gate
+class CombinedMemoryUnit final : public Gate
 {
     Register ra_;
     Register rd_;
-    Ram16x16 ram_;
+    std::unique_ptr<RamUnit> ram_;
 
 public:
-    CombinedMemoryUnit(Signal& sel_a, Signal& sel_d, Signal& sel_pa, Signal16& x, Signal& clk, Signal16& a, Signal16& d, Signal16 &pa) :
+    CombinedMemoryUnit(Signal& sel_a, Signal& sel_d, Signal& sel_pa, Signal16& x, Signal& clk, Signal16& a, Signal16& d, Signal16 &pa, unsigned behavioral = 0) :
         ra_{sel_a, x, clk, a},
         rd_{sel_d, x, clk, d},
-        ram_{sel_pa, x, a, clk, pa}
+        ram_{make_block<RamUnit, Ram16x16, BehavioralRam16x16>(behavioral & BEHAVIORAL_RAM, sel_pa, x, a, clk, pa)}
+    {
+    }
+
+    /// @return RAM contents at @c address, for simulation purposes.
+    uint16_t ram(size_t address) const
+    {
+        return ram_->word(address);
+    }
+
+    /// Store @c a, @c d and RAM contents @c ram without clocking, for simulation purposes.
+    void set(uint16_t a, uint16_t d, const std::array<uint16_t, 16>& ram)
     {
+        ra_.set(a);
+        rd_.set(d);
+        for (size_t address = 0; address < 16; ++address) {
+            ram_->set(address, ram[address]);
+        }
+    }
+
+    /// Name ports of flattened netlist.
+    void ports(Netlist& n)
+    {
+        ram_->ports(n);
     }
 
     void update() override
     {
         ra_.update();
         rd_.update();
-        ram_.update();
+        ram_->update();
     }
 };
 
+/// ROM, gate-level or behavioral.
+class RomUnit : public Gate
+{
+public:
+    /// @return Contents of word @c address, for simulation purposes.
+    virtual uint16_t word(size_t address) const = 0;
+
+    /// Name ports of flattened netlist.
+    virtual void ports(Netlist& n) = 0;
+};
+
 /// ROM.
 /// Not clocked.
-class Rom16x16 : public Gate
+class Rom16x16 final : public RomUnit
 {
-    std::vector<std::unique_ptr<SignalSet16>> rom_;
-    std::vector<std::unique_ptr<Signal16>> slices_;
-    std::vector<std::unique_ptr<Gate>> gates_;
+    SignalSet16 hot_;
+    Decoder4to16Gate decoder_;
+    std::array<SignalSet16, 16> rom_;
+    std::array<Signal16, 16> slices_;
+    std::array<OneHotMux16to1Gate, 16> gates_;
 
 public:
-    Rom16x16(std::vector<uint16_t>& program, Signal16& ad, Signal16& out)
+    Rom16x16(std::vector<uint16_t>& program, Signal16& ad, Signal16& out) :
+        decoder_{ad, hot_},
+        // For each bit, an instance of OneHotMux16to1Gate is used to select the address-specific bit.
+        // All share the address decoder.
+        slices_{transpose(rom_)},
+        gates_{make_array<OneHotMux16to1Gate, 16>([&](size_t bit) { return OneHotMux16to1Gate{slices_[bit], hot_, out.ref(bit)}; })}
     {
 	// ROM is modelled as 16x16 constant signals.
         for (size_t address = 0; address < 16; ++address) {
-	    auto s = std::make_unique<SignalSet16>();
-	    s->setint(program[address]);
-	    rom_.push_back(std::move(s));
+            rom_[address].setint(program[address]);
         }
+    }
+
+    uint16_t word(size_t address) const override
+    {
+        return rom_[address].getint();
+    }
 
-        // For each bit, an instance of Mux16to1Gate is used to select the address-specific bit.
-        for (size_t bit = 0; bit < 16; ++bit) {
-            auto slice = std::make_unique<Signal16>();
-            for (size_t address = 0; address < 16; ++address) {
-                slice->setptr(address, rom_[address]->ptr(bit));
-            }
-            gates_.push_back(std::make_unique<Mux16to1Gate>(*slice, ad, out.ref(bit)));
-            slices_.push_back(std::move(slice));
+    void ports(Netlist& n) override
+    {
+        for (size_t address = 0; address < 16; ++address) {
+            n.port("rom" + std::to_string(address), rom_[address]);
         }
     }
 
     void update() override
     {
+        decoder_.update();
         for (auto& g : gates_) {
-            g->update();
+            g.update();
         }
     }
 };
 
+/// Behavioral Rom16x16.
+class BehavioralRom16x16 final : public RomUnit, Behavioral
+{
+    std::array<uint16_t, 16> rom_;
+    Signal16& ad_;
+    Signal16& out_;
+
+public:
+    BehavioralRom16x16(std::vector<uint16_t>& program, Signal16& ad, Signal16& out) :
+        rom_{},
+        ad_{ad},
+        out_{out}
+    {
+        for (size_t address = 0; address < 16; ++address) {
+            rom_[address] = program[address];
+        }
+    }
+
+    uint16_t word(size_t address) const override
+    {
+        return rom_[address];
+    }
+
+    void ports(Netlist&) override
+    {
+        check();
+    }
+
+    void update() override
+    {
+        check();
+        out_.setint(rom_[ad_.getint() & 15]);
+    }
+};
+
+/// Architectural state of Computer: everything that survives from one clock cycle to the next.
+struct ArchState
+{
+    uint16_t pc;
+    uint16_t a;
+    uint16_t d;
+    std::array<uint16_t, 16> ram;
+};
+
 /// Computer.
 /// Each clock cycle changes the program counter depending on j.
+/// Blocks selected by @c behavioral (BEHAVIORAL_ROM etc.) are simulated behaviorally, with the same port signals;
+/// the remaining blocks are simulated by gates.
+/// A Computer with behavioral blocks cannot be recorded into a Netlist.
 class Computer : public Gate
 {
     Signal j_;
     SignalSet16 a_;
     SignalSet16 pc_;
-    Counter counter_;
+    std::unique_ptr<CounterUnit> counter_;
 
     SignalSet16 instr_;
-    Rom16x16 rom_;
+    std::unique_ptr<RomUnit> rom_;
 
     SignalSet16 d_;
     SignalSet16 pa_;
@@ -1333,16 +1835,41 @@ class Computer : public Gate
 
     CombinedMemoryUnit memory_;
 
+    /// Every signal, by netlist index, and the netlist fingerprint, for snapshots; recorded when first needed.
+    std::vector<Signal*> signals_;
+    uint64_t fingerprint_;
+
+    /// Record signals_, once.
+    void record_signals()
+    {
+        if (!signals_.empty()) {
+            return;
+        }
+
+        Netlist n{*this};
+        fingerprint_ = n.fingerprint();
+        for (auto s : n.addresses()) {
+            // Recording sees signals as const; they belong to this computer, or are its clk and halt.
+            signals_.push_back(const_cast<Signal*>(s));
+        }
+    }
+
 public:
-    Computer(std::vector<uint16_t>& program, Signal& clk, Signal& halt) :
-        counter_{j_, a_, clk, pc_},
+    /// Snapshot magic, followed by version (uint32_t), number of signals (uint32_t) and netlist fingerprint (uint64_t).
+    static constexpr char SNAPSHOT_MAGIC[8] = {'N', 'A', 'N', 'D', 'S', 'N', 'A', 'P'};
+    static constexpr uint32_t SNAPSHOT_VERSION = 1;
+    static constexpr size_t SNAPSHOT_HEADER = 24;
+
+    Computer(std::vector<uint16_t>& program, Signal& clk, Signal& halt, unsigned behavioral = 0) :
+        counter_{make_block<CounterUnit, Counter, BehavioralCounter>(behavioral & BEHAVIORAL_COUNTER, j_, a_, clk, pc_)},
 
-        rom_{program, pc_, instr_},
+        rom_{make_block<RomUnit, Rom16x16, BehavioralRom16x16>(behavioral & BEHAVIORAL_ROM, program, pc_, instr_)},
 
-        control_{instr_, a_, d_, pa_, r_, sel_a_, sel_d_, sel_pa_, j_},
+        control_{instr_, a_, d_, pa_, r_, sel_a_, sel_d_, sel_pa_, j_, behavioral},
         connect_{instr_.ref(14), halt},
 
-        memory_{sel_a_, sel_d_, sel_pa_, r_, clk, a_, d_, pa_}
+        memory_{sel_a_, sel_d_, sel_pa_, r_, clk, a_, d_, pa_, behavioral},
+        fingerprint_{}
     {
     }
 
@@ -1366,12 +1893,113 @@ public:
         return pa_.getint();
     }
 
+    /// @return RAM contents at @c address.
+    uint16_t ram(size_t address) const
+    {
+        return memory_.ram(address);
+    }
+
+    /// @return ROM contents at @c address.
+    uint16_t rom(size_t address) const
+    {
+        return rom_->word(address);
+    }
+
+    /// @return Architectural state.
+    ArchState state() const
+    {
+        ArchState s{pc(), a(), d(), {}};
+        for (size_t address = 0; address < 16; ++address) {
+            s.ram[address] = ram(address);
+        }
+        return s;
+    }
+
+    /// Load architectural state @c s into the registers, program counter and RAM flip-flops, without clocking.
+    /// The clock must be low, as between clock cycles.
+    /// The combinational logic is then settled, so the next clock cycle executes the instruction at the new PC;
+    /// the halt signal is left unchanged until then.
+    void set_state(const ArchState& s)
+    {
+        counter_->set(s.pc);
+        memory_.set(s.a, s.d, s.ram);
+
+        rom_->update();
+        control_.update();
+        memory_.update();
+        counter_->update();
+    }
+
+    /// Save every signal: registers, RAM, program counter, the internals of their flip-flops and latches,
+    /// the ROM, and @c clk and @c halt.
+    /// The first snapshot records the computer as a Netlist; recording is per thread, so other computers may be
+    /// simulated by other threads meanwhile, but this computer must not be used by another thread.
+    /// @return Snapshot: a header of SNAPSHOT_HEADER bytes (see SNAPSHOT_MAGIC), then one bit per signal.
+    /// @throws std::logic_error if any block is behavioral.
+    std::vector<uint8_t> save_state()
+    {
+        record_signals();
+
+        std::vector<uint8_t> blob(SNAPSHOT_HEADER + (signals_.size() + 7) / 8);
+        auto count = static_cast<uint32_t>(signals_.size());
+        memcpy(&blob[0], SNAPSHOT_MAGIC, sizeof SNAPSHOT_MAGIC);
+        memcpy(&blob[8], &SNAPSHOT_VERSION, sizeof SNAPSHOT_VERSION);
+        memcpy(&blob[12], &count, sizeof count);
+        memcpy(&blob[16], &fingerprint_, sizeof fingerprint_);
+        for (size_t i = 0; i < signals_.size(); ++i) {
+            blob[SNAPSHOT_HEADER + i / 8] = static_cast<uint8_t>(blob[SNAPSHOT_HEADER + i / 8] | (signals_[i]->get() << (i % 8)));
+        }
+        return blob;
+    }
+
+    /// Restore snapshot @c blob of @c size bytes, saved by a Computer of the same structure.
+    /// The program is part of the snapshot, so the computer may have been constructed with any program.
+    /// @throws std::invalid_argument if @c blob is not a snapshot of this structure.
+    /// @throws std::logic_error if any block is behavioral.
+    void restore_state(const uint8_t* blob, size_t size)
+    {
+        record_signals();
+
+        uint32_t version{};
+        uint32_t count{};
+        uint64_t fingerprint{};
+        if (size >= SNAPSHOT_HEADER) {
+            memcpy(&version, &blob[8], sizeof version);
+            memcpy(&count, &blob[12], sizeof count);
+            memcpy(&fingerprint, &blob[16], sizeof fingerprint);
+        }
+        if (size != SNAPSHOT_HEADER + (signals_.size() + 7) / 8 || memcmp(blob, SNAPSHOT_MAGIC, sizeof SNAPSHOT_MAGIC) ||
+            version != SNAPSHOT_VERSION || count != signals_.size() || fingerprint != fingerprint_) {
+            throw std::invalid_argument("not a snapshot of this computer");
+        }
+
+        for (size_t i = 0; i < signals_.size(); ++i) {
+            signals_[i]->set((blob[SNAPSHOT_HEADER + i / 8] >> (i % 8)) & 1);
+        }
+    }
+
+    void restore_state(const std::vector<uint8_t>& blob)
+    {
+        restore_state(blob.data(), blob.size());
+    }
+
+    /// Name ports of flattened netlist.
+    void ports(Netlist& n)
+    {
+        n.port("pc", pc_);
+        n.port("a", a_);
+        n.port("d", d_);
+        n.port("pa", pa_);
+        rom_->ports(n);
+        memory_.ports(n);
+    }
+
     void update() override
     {
-        rom_.update();
+        rom_->update();
         control_.update();
         memory_.update();
-        counter_.update();
+        counter_->update();
         connect_.update();
     }
 };
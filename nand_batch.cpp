@@ -0,0 +1,45 @@
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <unistd.h>
+
+#include "batch.h"
+
+static void usage()
+{
+    fprintf(stderr, "usage: nand_batch [-c cycles] [-j threads] directory|packed-file\n");
+    exit(2);
+}
+
+/// Run many ROM images, one Computer per image, on all cores.
+int main(int argc, char* argv[])
+{
+    uint64_t budget = 1000000;
+    unsigned threads = 0;
+
+    int c;
+    while ((c = getopt(argc, argv, "c:j:")) != -1) {
+        switch (c) {
+        case 'c':
+            budget = strtoull(optarg, nullptr, 0);
+            break;
+        case 'j':
+            threads = static_cast<unsigned>(strtoul(optarg, nullptr, 0));
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind + 1 != argc) {
+        usage();
+    }
+
+    try {
+        auto jobs = load_batch(argv[optind]);
+        auto results = run_batch(jobs, budget, threads);
+        print_batch(jobs, results, stdout);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "nand_batch: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,63 @@
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "census.h"
+#include "example.cpp"
+#include "fast.cpp"
+#include "flat.cpp"
+
+/// Report construction of @c G from @c args, then time @c repetitions more constructions.
+template <typename G, typename... Args>
+static void report(const char* name, unsigned repetitions, Args&... args)
+{
+    printf("%s (%zu bytes):\n", name, sizeof(G));
+    census<G>(args...).first->print(stdout);
+
+    if (repetitions) {
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < repetitions; ++i) {
+            G g{args...};
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("mean time: %.3f ms over %u constructions\n", seconds * 1e3 / repetitions, repetitions);
+    }
+    printf("\n");
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: nand_census [-n repetitions]\n");
+    exit(2);
+}
+
+/// Report heap allocations, gates by class, signals and construction time of the computers.
+int main(int argc, char* argv[])
+{
+    unsigned repetitions = 0;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:")) != -1) {
+        switch (c) {
+        case 'n':
+            repetitions = static_cast<unsigned>(strtoul(optarg, nullptr, 0));
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind != argc) {
+        usage();
+    }
+
+    std::vector<uint16_t> program = example_program();
+    Signal clk;
+    Signal halt;
+    unsigned behavioral = BEHAVIORAL_ALL;
+
+    report<Computer>("Computer", repetitions, program, clk, halt);
+    report<Computer>("Computer (behavioral blocks)", repetitions, program, clk, halt, behavioral);
+    report<FastComputer>("FastComputer", repetitions, program, clk, halt);
+    report<FlatComputer>("FlatComputer", repetitions, program, clk, halt);
+    report<OptimizedComputer>("OptimizedComputer", repetitions, program, clk, halt);
+}
@@ -0,0 +1,74 @@
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <unistd.h>
+
+#include "batch.h"
+#include "cosim.cpp"
+#include "example.cpp"
+#include "flat.cpp"
+
+static void usage()
+{
+    fprintf(stderr, "usage: nand_cosim [-c cycles] [-n interval] [-O] [directory|packed-file]\n");
+    exit(2);
+}
+
+/// Co-simulate each job against FastComputer.
+/// @return Number of jobs that diverged.
+template <typename Model>
+static int cosimulate(std::vector<BatchJob>& jobs, uint64_t cycles, unsigned interval)
+{
+    int diverged{};
+    for (auto& job : jobs) {
+        Cosimulation<Model> sim{job.program, interval};
+        sim.run(cycles);
+        printf("%s: ", job.name.c_str());
+        sim.print(stdout);
+        diverged += sim.diverged();
+    }
+    return diverged;
+}
+
+/// Run programs on the gate-level Computer (or the optimized netlist) and the instruction-level model in lockstep.
+int main(int argc, char* argv[])
+{
+    uint64_t cycles = 1000;
+    unsigned interval = 1;
+    bool optimized = false;
+
+    int c;
+    while ((c = getopt(argc, argv, "c:n:O")) != -1) {
+        switch (c) {
+        case 'c':
+            cycles = strtoull(optarg, nullptr, 0);
+            break;
+        case 'n':
+            interval = static_cast<unsigned>(strtoul(optarg, nullptr, 0));
+            break;
+        case 'O':
+            optimized = true;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind + 1 < argc) {
+        usage();
+    }
+
+    try {
+        std::vector<BatchJob> jobs;
+        if (optind < argc) {
+            jobs = load_batch(argv[optind]);
+        } else {
+            jobs.push_back(BatchJob{"example", example_program()});
+        }
+
+        int diverged = optimized ? cosimulate<OptimizedComputer>(jobs, cycles, interval) : cosimulate<Computer>(jobs, cycles, interval);
+        return diverged ? 1 : 0;
+    } catch (const std::exception& e) {
+        fprintf(stderr, "nand_cosim: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <unistd.h>
+
+#include "batch.h"
+#include "example.cpp"
+#include "flat.cpp"
+#include "netfile.h"
+
+static void usage()
+{
+    fprintf(stderr, "usage: nand_netlist -w netlist-file\n");
+    fprintf(stderr, "       nand_netlist [-c cycles] [-p rom-image] netlist-file\n");
+    exit(2);
+}
+
+/// Write the netlist of Computer to a binary netlist file (-w);
+/// or map one, and run the example program (or the ROM image given by -p) until halt, printing the state each cycle.
+int main(int argc, char* argv[])
+{
+    bool write{};
+    uint64_t cycles = 1000000;
+    const char* image{};
+
+    int c;
+    while ((c = getopt(argc, argv, "c:p:w")) != -1) {
+        switch (c) {
+        case 'c':
+            cycles = strtoull(optarg, nullptr, 0);
+            break;
+        case 'p':
+            image = optarg;
+            break;
+        case 'w':
+            write = true;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind + 1 != argc) {
+        usage();
+    }
+    const char* path = argv[optind];
+
+    try {
+        std::vector<uint16_t> program = example_program();
+        if (image) {
+            program = load_batch(image).at(0).program;
+        }
+
+        Signal clk;
+        Signal halt;
+        if (write) {
+            write_netlist(flatten(program, clk, halt), path);
+            return 0;
+        }
+
+        MappedNetlist n{path};
+        MappedComputer g{n, program, clk, halt};
+        for (uint64_t i = 0; i < cycles && !halt.get(); ++i) {
+            // Show state.
+            printf("PC:%04x A:%04x D:%04x PA:%04x\n", g.pc(), g.a(), g.d(), g.pa());
+
+            // Clock pulse.
+            clk.set(1);
+            g.update();
+            clk.set(0);
+            g.update();
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "nand_netlist: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,75 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+#include "example.cpp"
+#include "flat.cpp"
+
+/// Time @c cycles clock cycles of @c engine on the flattened netlist @c n.
+template <typename Engine>
+static double run(Engine& engine, const Netlist& n, unsigned cycles)
+{
+    std::vector<uint8_t> state{n.initial()};
+    uint32_t clk = n.port("clk").bits[0];
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < cycles; ++i) {
+        state[clk] = 1;
+        engine.evaluate(state.data());
+        state[clk] = 0;
+        engine.evaluate(state.data());
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: nand_partition [-c cycles] [-j threads] [-O]\n");
+    exit(2);
+}
+
+/// Report partitioning of the flattened Computer, and the speedup over a single thread.
+int main(int argc, char* argv[])
+{
+    unsigned cycles = 2000;
+    unsigned threads = 0;
+    bool optimized = false;
+
+    int c;
+    while ((c = getopt(argc, argv, "c:j:O")) != -1) {
+        switch (c) {
+        case 'c':
+            cycles = static_cast<unsigned>(strtoul(optarg, nullptr, 0));
+            break;
+        case 'j':
+            threads = static_cast<unsigned>(strtoul(optarg, nullptr, 0));
+            break;
+        case 'O':
+            optimized = true;
+            break;
+        default:
+            usage();
+        }
+    }
+
+    std::vector<uint16_t> program = example_program();
+    Signal clk;
+    Signal halt;
+    Netlist n = flatten(program, clk, halt);
+    if (optimized) {
+        n = optimize(n);
+    }
+
+    Interpreter serial{n};
+    PartitionedInterpreter partitioned{n, threads};
+
+    printf("operations: %zu\n", n.ops().size());
+    partitioned.print(stdout);
+
+    double t1 = run(serial, n, cycles);
+    double tn = run(partitioned, n, cycles);
+    printf("serial: %.0f cycles/s\n", cycles / t1);
+    printf("partitioned: %.0f cycles/s\n", cycles / tn);
+    printf("speedup: %.2f\n", t1 / tn);
+}
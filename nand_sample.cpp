@@ -0,0 +1,68 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <unistd.h>
+
+#include "batch.h"
+#include "example.cpp"
+#include "sample.cpp"
+
+static void usage()
+{
+    fprintf(stderr, "usage: nand_sample [-c cycles] [-s skip] [-w window] [directory|packed-file]\n");
+    exit(2);
+}
+
+/// Run programs with sampled simulation: FastComputer between detailed windows of the gate-level Computer.
+int main(int argc, char* argv[])
+{
+    uint64_t cycles = 1000000;
+    uint64_t skip = 10000;
+    uint64_t window = 100;
+
+    int c;
+    while ((c = getopt(argc, argv, "c:s:w:")) != -1) {
+        switch (c) {
+        case 'c':
+            cycles = strtoull(optarg, nullptr, 0);
+            break;
+        case 's':
+            skip = strtoull(optarg, nullptr, 0);
+            break;
+        case 'w':
+            window = strtoull(optarg, nullptr, 0);
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind + 1 < argc) {
+        usage();
+    }
+
+    try {
+        std::vector<BatchJob> jobs;
+        if (optind < argc) {
+            jobs = load_batch(argv[optind]);
+        } else {
+            jobs.push_back(BatchJob{"example", example_program()});
+        }
+
+        uint64_t mismatches{};
+        for (auto& job : jobs) {
+            auto start = std::chrono::steady_clock::now();
+            SampledSimulation sim{job.program, skip, window};
+            sim.run(cycles);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            printf("%s: ", job.name.c_str());
+            sim.print(stdout);
+            printf("  %.3f s\n", seconds);
+            mismatches += sim.mismatches();
+        }
+        return mismatches ? 1 : 0;
+    } catch (const std::exception& e) {
+        fprintf(stderr, "nand_sample: %s\n", e.what());
+        return 1;
+    }
+}
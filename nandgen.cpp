@@ -0,0 +1,89 @@
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <utility>
+
+#include "codegen.h"
+#include "example.cpp"
+#include "flat.cpp"
+
+/// @return Name @c name and number of NAND operations in one update() of a gate @c G constructed from @c args.
+template <typename G, typename... Args>
+static std::pair<std::string, size_t> nands(const std::string& name, Args&&... args)
+{
+    G g{std::forward<Args>(args)...};
+    Netlist n{g};
+    size_t count{};
+    for (const auto& op : n.ops()) {
+        count += (op.code == Netlist::NAND);
+    }
+    return {name, count};
+}
+
+/// @return NAND counts of the components of Computer.
+static std::vector<std::pair<std::string, size_t>> components(std::vector<uint16_t>& program)
+{
+    Signal s[8];
+    SignalSet16 w[8];
+    return {
+        nands<NandGate>("NandGate", s[0], s[1], s[2]),
+        nands<NotGate>("NotGate", s[0], s[1]),
+        nands<AndGate>("AndGate", s[0], s[1], s[2]),
+        nands<OrGate>("OrGate", s[0], s[1], s[2]),
+        nands<XorGate>("XorGate", s[0], s[1], s[2]),
+        nands<SelectGate>("SelectGate", s[0], s[1], s[2], s[3]),
+        nands<HalfAdderGate>("HalfAdderGate", s[0], s[1], s[2], s[3]),
+        nands<FullAdderGate>("FullAdderGate", s[0], s[1], s[2], s[3], s[4]),
+        nands<Add16Gate>("Add16Gate", w[0], w[1], s[0], w[2], s[1]),
+        nands<DataLatchGate>("DataLatchGate", s[0], s[1], s[2]),
+        nands<DataFlipFlop>("DataFlipFlop", s[0], s[1], s[2], s[3]),
+        nands<Register>("Register", s[0], w[0], s[1], w[1]),
+        nands<Ram16x16>("Ram16x16", s[0], w[0], w[1], s[1], w[2]),
+        nands<Rom16x16>("Rom16x16", program, w[0], w[1]),
+        nands<Counter>("Counter", s[0], w[0], s[1], w[1]),
+        nands<ControlUnit>("ControlUnit", w[0], w[1], w[2], w[3], w[4], s[0], s[1], s[2], s[3]),
+        nands<CombinedMemoryUnit>("CombinedMemoryUnit", s[0], s[1], s[2], w[0], s[3], w[1], w[2], w[3]),
+        nands<Computer>("Computer", program, s[0], s[1]),
+    };
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: nandgen [-t]\n");
+    exit(2);
+}
+
+/// Emit a straight-line C++ simulator of Computer running the example program.
+/// The optimization summary is printed on stderr.
+/// With -t, emit instead the unoptimized netlist of Computer as constant tables (ComputerNetlist), with the NAND counts
+/// of its components; the program is not folded, so any program can be loaded into its ROM signals.
+int main(int argc, char* argv[])
+{
+    bool tables{};
+
+    int c;
+    while ((c = getopt(argc, argv, "t")) != -1) {
+        switch (c) {
+        case 't':
+            tables = true;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind != argc) {
+        usage();
+    }
+
+    std::vector<uint16_t> program = example_program();
+    Signal clk;
+    Signal halt;
+    if (tables) {
+        generate_tables(flatten(program, clk, halt), "ComputerNetlist", components(program), stdout);
+        return 0;
+    }
+
+    Optimization o{flatten(program, clk, halt), {"clk"}};
+    o.print(stderr);
+    generate(o.netlist(), {"clk"}, stdout);
+}
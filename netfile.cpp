@@ -0,0 +1,264 @@
+#include "netfile.h"
+#include "levelize.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char NETFILE_MAGIC[8] = {'N', 'A', 'N', 'D', 'N', 'E', 'T', 0};
+static const uint32_t NETFILE_VERSION = 1;
+static const uint32_t NETFILE_BYTE_ORDER = 0x01020304;
+
+static_assert(sizeof(Netlist::Op) == 16 && offsetof(Netlist::Op, a) == 4 && offsetof(Netlist::Op, b) == 8 &&
+    offsetof(Netlist::Op, out) == 12, "operations are stored as Netlist::Op");
+static_assert(sizeof(NetfileHeader) % 8 == 0 && sizeof(NetfilePort) % 8 == 0, "records must keep 8-byte alignment");
+
+/// @return @c n rounded up to a multiple of 8.
+static uint64_t align8(uint64_t n)
+{
+    return (n + 7) & ~uint64_t{7};
+}
+
+void write_netlist(const Netlist& n, const std::string& path)
+{
+    Levelization l{n};
+    auto ops = l.schedule();
+
+    std::vector<uint32_t> levels(l.depth() + 1);
+    for (auto level : l.level()) {
+        levels[level + 1]++;
+    }
+    for (size_t i = 1; i < levels.size(); ++i) {
+        levels[i] += levels[i - 1];
+    }
+
+    size_t bits{};
+    for (const auto& p : n.ports()) {
+        bits += p.bits.size();
+    }
+
+    NetfileHeader h{};
+    memcpy(h.magic, NETFILE_MAGIC, sizeof NETFILE_MAGIC);
+    h.version = NETFILE_VERSION;
+    h.byte_order = NETFILE_BYTE_ORDER;
+    h.signals = n.signals();
+    h.operations = ops.size();
+    h.depth = l.depth();
+    h.ports = n.ports().size();
+    h.bits = bits;
+    h.initial_offset = sizeof h;
+    h.ops_offset = align8(h.initial_offset + h.signals);
+    h.levels_offset = h.ops_offset + h.operations * sizeof(Netlist::Op);
+    h.ports_offset = align8(h.levels_offset + levels.size() * sizeof(uint32_t));
+    h.bits_offset = h.ports_offset + h.ports * sizeof(NetfilePort);
+    h.size = align8(h.bits_offset + h.bits * sizeof(uint32_t));
+
+    // Built field by field, so that padding is zero.
+    std::vector<uint8_t> buf(h.size);
+    memcpy(&buf[0], &h, sizeof h);
+    memcpy(&buf[h.initial_offset], n.initial().data(), h.signals);
+    for (size_t i = 0; i < ops.size(); ++i) {
+        uint8_t* p = &buf[h.ops_offset + i * sizeof(Netlist::Op)];
+        p[offsetof(Netlist::Op, code)] = ops[i].code;
+        memcpy(p + offsetof(Netlist::Op, a), &ops[i].a, sizeof(uint32_t));
+        memcpy(p + offsetof(Netlist::Op, b), &ops[i].b, sizeof(uint32_t));
+        memcpy(p + offsetof(Netlist::Op, out), &ops[i].out, sizeof(uint32_t));
+    }
+    memcpy(&buf[h.levels_offset], levels.data(), levels.size() * sizeof(uint32_t));
+
+    uint32_t offset{};
+    for (size_t i = 0; i < n.ports().size(); ++i) {
+        const auto& p = n.ports()[i];
+        NetfilePort e{};
+        if (p.name.size() >= sizeof e.name) {
+            throw std::runtime_error("port name too long: " + p.name);
+        }
+        memcpy(e.name, p.name.data(), p.name.size());
+        e.offset = offset;
+        e.size = static_cast<uint32_t>(p.bits.size());
+        memcpy(&buf[h.ports_offset + i * sizeof e], &e, sizeof e);
+        memcpy(&buf[h.bits_offset + offset * sizeof(uint32_t)], p.bits.data(), p.bits.size() * sizeof(uint32_t));
+        offset += e.size;
+    }
+
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        throw std::runtime_error("cannot write " + path);
+    }
+    bool ok = fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        throw std::runtime_error("cannot write " + path);
+    }
+}
+
+MappedNetlist::MappedNetlist(const std::string& path) :
+    base_{MAP_FAILED},
+    size_{},
+    header_{}
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot read " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(NetfileHeader)) {
+        size_ = static_cast<size_t>(st.st_size);
+        base_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base_ == MAP_FAILED) {
+        throw std::runtime_error("cannot map " + path);
+    }
+
+    header_ = static_cast<const NetfileHeader*>(base_);
+    const auto& h = *header_;
+
+    auto fits = [&](uint64_t offset, uint64_t count, uint64_t size)
+    {
+        return offset % 8 == 0 && offset <= size_ && count <= (size_ - offset) / size;
+    };
+    bool valid = memcmp(h.magic, NETFILE_MAGIC, sizeof NETFILE_MAGIC) == 0 &&
+        h.version == NETFILE_VERSION && h.byte_order == NETFILE_BYTE_ORDER &&
+        h.size == size_ && h.signals <= UINT32_MAX &&
+        fits(h.initial_offset, h.signals, 1) &&
+        fits(h.ops_offset, h.operations, sizeof(Netlist::Op)) &&
+        h.depth < UINT32_MAX && fits(h.levels_offset, h.depth + 1, sizeof(uint32_t)) &&
+        fits(h.ports_offset, h.ports, sizeof(NetfilePort)) &&
+        fits(h.bits_offset, h.bits, sizeof(uint32_t));
+
+    for (size_t i = 0; valid && i < h.operations; ++i) {
+        const auto& op = ops()[i];
+        valid = op.code <= Netlist::OR && op.a < h.signals && op.b < h.signals && op.out < h.signals;
+    }
+    for (size_t i = 0; valid && i <= h.depth; ++i) {
+        valid = level(i) <= h.operations && (i == 0 || level(i - 1) <= level(i));
+    }
+    valid = valid && level(h.depth) == h.operations;
+    for (size_t i = 0; valid && i < h.ports; ++i) {
+        const auto& p = port(i);
+        valid = memchr(p.name, 0, sizeof p.name) && p.offset <= h.bits && p.size <= h.bits - p.offset;
+        for (size_t bit = 0; valid && bit < p.size; ++bit) {
+            valid = bits(p)[bit] < h.signals;
+        }
+    }
+
+    if (!valid) {
+        munmap(base_, size_);
+        throw std::runtime_error("bad netlist file: " + path);
+    }
+}
+
+MappedNetlist::~MappedNetlist()
+{
+    munmap(base_, size_);
+}
+
+const uint8_t* MappedNetlist::initial() const
+{
+    return static_cast<const uint8_t*>(base_) + header_->initial_offset;
+}
+
+const Netlist::Op* MappedNetlist::ops() const
+{
+    return reinterpret_cast<const Netlist::Op*>(static_cast<const uint8_t*>(base_) + header_->ops_offset);
+}
+
+uint32_t MappedNetlist::level(size_t level) const
+{
+    return reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(base_) + header_->levels_offset)[level];
+}
+
+const NetfilePort& MappedNetlist::port(size_t i) const
+{
+    return reinterpret_cast<const NetfilePort*>(static_cast<const uint8_t*>(base_) + header_->ports_offset)[i];
+}
+
+const NetfilePort& MappedNetlist::port(const std::string& name) const
+{
+    for (size_t i = 0; i < ports(); ++i) {
+        if (name == port(i).name) {
+            return port(i);
+        }
+    }
+    throw std::out_of_range("no such port: " + name);
+}
+
+const uint32_t* MappedNetlist::bits(const NetfilePort& p) const
+{
+    return reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(base_) + header_->bits_offset) + p.offset;
+}
+
+MappedSimulator::MappedSimulator(const MappedNetlist& n) :
+    netlist_{n},
+    state_{n.initial(), n.initial() + n.signals()}
+{
+}
+
+void MappedSimulator::evaluate()
+{
+    const Netlist::Op* ops = netlist_.ops();
+    uint8_t* state = state_.data();
+    for (size_t i = 0, end = netlist_.operations(); i < end; ++i) {
+        state[ops[i].out] = Netlist::apply(ops[i].code, state[ops[i].a], state[ops[i].b]);
+    }
+}
+
+uint16_t MappedSimulator::get(const NetfilePort& p) const
+{
+    const uint32_t* bits = netlist_.bits(p);
+    uint16_t x{};
+    for (size_t bit = 0; bit < p.size; ++bit) {
+        x = static_cast<uint16_t>(x | (state_[bits[bit]] << bit));
+    }
+    return x;
+}
+
+void MappedSimulator::set(const NetfilePort& p, uint16_t x)
+{
+    const uint32_t* bits = netlist_.bits(p);
+    for (size_t bit = 0; bit < p.size; ++bit) {
+        state_[bits[bit]] = (x >> bit) & 1;
+    }
+}
+
+/// @return Port @c name of @c n, which must be @c size signals wide.
+/// @throws std::runtime_error otherwise.
+static const NetfilePort& sized_port(const MappedNetlist& n, const std::string& name, uint32_t size)
+{
+    const auto& p = n.port(name);
+    if (p.size != size) {
+        throw std::runtime_error("bad netlist file: port " + name + " has " + std::to_string(p.size) + " signals");
+    }
+    return p;
+}
+
+MappedComputer::MappedComputer(const MappedNetlist& n, std::vector<uint16_t>& program, Signal& clk, Signal& halt) :
+    clk_{clk},
+    halt_{halt},
+    simulator_{n},
+    clk_port_{sized_port(n, "clk", 1)},
+    halt_port_{sized_port(n, "halt", 1)},
+    pc_{sized_port(n, "pc", 16)},
+    a_{sized_port(n, "a", 16)},
+    d_{sized_port(n, "d", 16)},
+    pa_{sized_port(n, "pa", 16)}
+{
+    for (size_t address = 0; address < 16; ++address) {
+        rom_.push_back(&sized_port(n, "rom" + std::to_string(address), 16));
+        ram_.push_back(&sized_port(n, "ram" + std::to_string(address), 16));
+        simulator_.set(*rom_[address], program[address]);
+    }
+}
+
+void MappedComputer::update()
+{
+    simulator_.set(clk_port_, static_cast<uint16_t>(clk_.get()));
+    simulator_.evaluate();
+    halt_.set(simulator_.get(halt_port_));
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "gateif.h"
+#include "netlist.h"
+#include "signal.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Binary netlist file.
+/// Holds a netlist in a form that is used in place after a single mmap(), without parsing, so that processes
+/// simulating the same design share one page-cached copy.
+///
+/// All integers are in host byte order, which the header records; records are 8-byte aligned:
+/// - NetfileHeader;
+/// - uint8_t initial[signals], the recorded signal values;
+/// - Netlist::Op ops[operations], in level order (see Levelization);
+/// - uint32_t levels[depth + 1], the index in ops of the first operation of each level, then the number of operations;
+/// - NetfilePort ports[ports];
+/// - uint32_t bits[], the signal indices of all ports, least significant first.
+struct NetfileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t size;
+    uint64_t signals;
+    uint64_t operations;
+    uint64_t depth;
+    uint64_t ports;
+    uint64_t bits;
+    uint64_t initial_offset;
+    uint64_t ops_offset;
+    uint64_t levels_offset;
+    uint64_t ports_offset;
+    uint64_t bits_offset;
+};
+
+/// Named group of signals in a netlist file.
+struct NetfilePort
+{
+    char name[24];
+    uint32_t offset;
+    uint32_t size;
+};
+
+/// Write netlist @c n to @c path, with its operations in level order.
+/// @throws std::runtime_error if the file cannot be written, or a port name is too long.
+void write_netlist(const Netlist& n, const std::string& path);
+
+/// Memory-mapped netlist file.
+class MappedNetlist
+{
+    void* base_;
+    size_t size_;
+    const NetfileHeader* header_;
+
+public:
+    /// Map the file at @c path, read-only and shared.
+    /// Only the header, the section bounds and the signal indices are checked.
+    /// @throws std::runtime_error if the file cannot be mapped or is not a valid netlist file.
+    explicit MappedNetlist(const std::string& path);
+
+    MappedNetlist(const MappedNetlist&) = delete;
+    MappedNetlist& operator=(const MappedNetlist&) = delete;
+
+    ~MappedNetlist();
+
+    /// @return Number of signals.
+    size_t signals() const
+    {
+        return header_->signals;
+    }
+
+    /// @return Signal values at time of recording.
+    const uint8_t* initial() const;
+
+    /// @return Number of operations.
+    size_t operations() const
+    {
+        return header_->operations;
+    }
+
+    /// @return Operations in level order.
+    const Netlist::Op* ops() const;
+
+    /// @return Number of levels.
+    size_t depth() const
+    {
+        return header_->depth;
+    }
+
+    /// @return Index in ops() of the first operation of level @c level; of level depth(), the number of operations.
+    uint32_t level(size_t level) const;
+
+    /// @return Number of ports.
+    size_t ports() const
+    {
+        return header_->ports;
+    }
+
+    /// @return Port @c i.
+    const NetfilePort& port(size_t i) const;
+
+    /// @return Port called @c name.
+    /// @throws std::out_of_range if there is none.
+    const NetfilePort& port(const std::string& name) const;
+
+    /// @return Signal indices of port @c p, least significant first.
+    const uint32_t* bits(const NetfilePort& p) const;
+};
+
+/// Simulator of a mapped netlist.
+/// Only the signal values are private to the simulator; the operations are read from the mapping.
+class MappedSimulator
+{
+    const MappedNetlist& netlist_;
+    std::vector<uint8_t> state_;
+
+public:
+    explicit MappedSimulator(const MappedNetlist& n);
+
+    /// Evaluate all operations once, in level order.
+    void evaluate();
+
+    /// @return Value of port @c p.
+    uint16_t get(const NetfilePort& p) const;
+
+    /// Set value of port @c p.
+    void set(const NetfilePort& p, uint16_t x);
+};
+
+/// Computer simulated from a mapped netlist file of a Computer (see flatten()).
+/// Behaves exactly as Computer running @c program: the program is loaded into the ROM signals,
+/// so one file serves any program.
+class MappedComputer : public Gate
+{
+    Signal& clk_;
+    Signal& halt_;
+    MappedSimulator simulator_;
+    const NetfilePort& clk_port_;
+    const NetfilePort& halt_port_;
+    const NetfilePort& pc_;
+    const NetfilePort& a_;
+    const NetfilePort& d_;
+    const NetfilePort& pa_;
+    std::vector<const NetfilePort*> rom_;
+    std::vector<const NetfilePort*> ram_;
+
+public:
+    /// @throws std::runtime_error if clk and halt are not one signal wide, or pc, a, d, pa, rom0..15 and ram0..15
+    /// are not 16 signals wide.
+    /// @throws std::out_of_range if a port is missing.
+    MappedComputer(const MappedNetlist& n, std::vector<uint16_t>& program, Signal& clk, Signal& halt);
+
+    uint16_t pc() const
+    {
+        return simulator_.get(pc_);
+    }
+
+    uint16_t a() const
+    {
+        return simulator_.get(a_);
+    }
+
+    uint16_t d() const
+    {
+        return simulator_.get(d_);
+    }
+
+    uint16_t pa() const
+    {
+        return simulator_.get(pa_);
+    }
+
+    /// @return RAM contents at @c address.
+    uint16_t ram(size_t address) const
+    {
+        return simulator_.get(*ram_[address]);
+    }
+
+    /// @return ROM contents at @c address.
+    uint16_t rom(size_t address) const
+    {
+        return simulator_.get(*rom_[address]);
+    }
+
+    void update() override;
+};
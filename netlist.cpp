@@ -0,0 +1,113 @@
+#include "netlist.h"
+
+#include <stdexcept>
+#include <utility>
+
+Netlist::Netlist()
+{
+}
+
+Netlist::Netlist(Gate& g)
+{
+    recording_ = this;
+    try {
+        g.update();
+    } catch (...) {
+        recording_ = nullptr;
+        throw;
+    }
+    recording_ = nullptr;
+}
+
+Netlist::Netlist(const Netlist& n, std::vector<Op> ops) :
+    index_{n.index_},
+    initial_{n.initial_},
+    ops_{std::move(ops)},
+    ports_{n.ports_}
+{
+}
+
+Netlist::Netlist(const Netlist& n, std::vector<Op> ops, std::vector<uint8_t> initial) :
+    index_{n.index_},
+    initial_{std::move(initial)},
+    ops_{std::move(ops)},
+    ports_{n.ports_}
+{
+}
+
+uint32_t Netlist::intern(const Signal& s)
+{
+    auto it = index_.find(&s);
+    if (it != index_.end()) {
+        return it->second;
+    }
+
+    auto i = static_cast<uint32_t>(initial_.size());
+    index_[&s] = i;
+    initial_.push_back(static_cast<uint8_t>(s.get()));
+    return i;
+}
+
+void Netlist::nand(const Signal& a, const Signal& b, const Signal& out)
+{
+    ops_.push_back(Op{NAND, intern(a), intern(b), intern(out)});
+}
+
+void Netlist::connect(const Signal& in, const Signal& out)
+{
+    auto i = intern(in);
+    ops_.push_back(Op{CONNECT, i, i, intern(out)});
+}
+
+uint32_t Netlist::index(const Signal& s) const
+{
+    auto it = index_.find(&s);
+    if (it == index_.end()) {
+        throw std::out_of_range("signal not in netlist");
+    }
+    return it->second;
+}
+
+std::vector<const Signal*> Netlist::addresses() const
+{
+    std::vector<const Signal*> v(initial_.size());
+    for (const auto& entry : index_) {
+        v[entry.second] = entry.first;
+    }
+    return v;
+}
+
+uint64_t Netlist::fingerprint() const
+{
+    // FNV-1a.
+    uint64_t h = 0xcbf29ce484222325;
+    auto add = [&](uint32_t x)
+    {
+        for (unsigned i = 0; i < 4; ++i) {
+            h = (h ^ ((x >> (8 * i)) & 0xff)) * 0x100000001b3;
+        }
+    };
+    add(static_cast<uint32_t>(initial_.size()));
+    for (const auto& op : ops_) {
+        add(op.code);
+        add(op.a);
+        add(op.b);
+        add(op.out);
+    }
+    return h;
+}
+
+void Netlist::port(const std::string& name, const Signal& s)
+{
+    ports_.push_back(Port{name, {index(s)}});
+}
+
+const Netlist::Port& Netlist::port(const std::string& name) const
+{
+    for (const auto& p : ports_) {
+        if (p.name == name) {
+            return p;
+        }
+    }
+    throw std::out_of_range("no such port: " + name);
+}
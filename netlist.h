@@ -0,0 +1,152 @@
+#pragma once
+
+#include "gateif.h"
+#include "signal.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Flattened gate.
+/// Records the NAND and connector operations performed by one update() of a (composite) gate,
+/// in evaluation order, with every signal replaced by an index into a flat signal array.
+class Netlist
+{
+public:
+    enum Opcode : uint8_t
+    {
+        NAND,
+        CONNECT,
+        AND,
+        OR
+    };
+
+    /// One operation.
+    /// NAND: out = !(a && b)
+    /// CONNECT: out = a
+    /// AND: out = a && b
+    /// OR: out = a || b
+    /// Recording only produces NAND and CONNECT; AND and OR are produced by Optimization.
+    struct Op
+    {
+        Opcode code;
+        uint32_t a;
+        uint32_t b;
+        uint32_t out;
+    };
+
+    /// @return Result of operation @c code on values @c a and @c b.
+    static uint8_t apply(Opcode code, uint8_t a, uint8_t b)
+    {
+        switch (code) {
+        case NAND:
+            return !(a && b);
+        case CONNECT:
+            return a;
+        case AND:
+            return a && b;
+        case OR:
+            return a || b;
+        }
+        return 0;
+    }
+
+    /// Named group of signals.
+    struct Port
+    {
+        std::string name;
+        std::vector<uint32_t> bits;
+    };
+
+private:
+    /// Netlist currently being recorded by this thread, if any.
+    /// Per thread, so that gates updated by other threads meanwhile are evaluated, not recorded.
+    /// Defined inline, so that the check in every NAND gate is a plain thread-local load.
+    static inline thread_local Netlist* recording_{};
+
+    std::unordered_map<const Signal*, uint32_t> index_;
+    std::vector<uint8_t> initial_;
+    std::vector<Op> ops_;
+    std::vector<Port> ports_;
+
+    uint32_t intern(const Signal& s);
+
+public:
+    /// Construct empty netlist.
+    Netlist();
+
+    /// Record gate @c g.
+    /// Neither the gate nor its signals are modified.
+    /// Signals are looked up by address, so index() and port() require them to be alive.
+    explicit Netlist(Gate& g);
+
+    /// Copy of @c n (signals and ports) with operations @c ops.
+    Netlist(const Netlist& n, std::vector<Op> ops);
+
+    /// Copy of @c n (signals and ports) with operations @c ops and signal values @c initial.
+    Netlist(const Netlist& n, std::vector<Op> ops, std::vector<uint8_t> initial);
+
+    /// @return Netlist being recorded by this thread, or nullptr.
+    static Netlist* recording()
+    {
+        return recording_;
+    }
+
+    /// Record NAND operation.
+    void nand(const Signal& a, const Signal& b, const Signal& out);
+
+    /// Record connector operation.
+    void connect(const Signal& in, const Signal& out);
+
+    /// @return Index of signal @c s.
+    uint32_t index(const Signal& s) const;
+
+    /// @return Number of signals.
+    size_t signals() const
+    {
+        return initial_.size();
+    }
+
+    /// @return Address of each signal, by index.
+    /// Only valid while the signals are alive.
+    std::vector<const Signal*> addresses() const;
+
+    /// @return Hash of the operations, identifying the structure of the netlist.
+    uint64_t fingerprint() const;
+
+    /// @return Signal values at time of recording.
+    const std::vector<uint8_t>& initial() const
+    {
+        return initial_;
+    }
+
+    /// @return Operations in evaluation order.
+    const std::vector<Op>& ops() const
+    {
+        return ops_;
+    }
+
+    /// Name a single signal.
+    void port(const std::string& name, const Signal& s);
+
+    /// Name a set of signals, least significant first.
+    template <size_t N>
+    void port(const std::string& name, SignalN<N>& s)
+    {
+        Port p{name, {}};
+        for (size_t i = 0; i < N; ++i) {
+            p.bits.push_back(index(s.ref(i)));
+        }
+        ports_.push_back(p);
+    }
+
+    /// @return Port called @c name.
+    const Port& port(const std::string& name) const;
+
+    /// @return All ports.
+    const std::vector<Port>& ports() const
+    {
+        return ports_;
+    }
+};
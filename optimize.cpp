@@ -0,0 +1,268 @@
+#include "optimize.h"
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+Optimization::Optimization(const Netlist& n, const std::vector<std::string>& inputs) :
+    netlist_{n},
+    before_{n.ops().size()},
+    folded_{},
+    collapsed_{},
+    shared_{},
+    eliminated_{}
+{
+    const size_t count = n.signals();
+    const uint32_t none = ~uint32_t{};
+    std::vector<Netlist::Op> ops{n.ops()};
+    std::vector<uint8_t> initial{n.initial()};
+
+    std::vector<uint8_t> input(count);
+    std::vector<uint8_t> observed(count);
+    for (const auto& p : n.ports()) {
+        bool is_input = std::find(inputs.begin(), inputs.end(), p.name) != inputs.end();
+        for (auto s : p.bits) {
+            observed[s] = 1;
+            input[s] = input[s] || is_input;
+        }
+    }
+
+    // Connectivity of the current operations.
+    std::vector<std::vector<uint32_t>> writers;
+    std::vector<std::vector<uint32_t>> readers;
+    auto connect = [&]()
+    {
+        writers.assign(count, {});
+        readers.assign(count, {});
+        for (uint32_t i = 0; i < ops.size(); ++i) {
+            writers[ops[i].out].push_back(i);
+            readers[ops[i].a].push_back(i);
+            if (ops[i].b != ops[i].a) {
+                readers[ops[i].b].push_back(i);
+            }
+        }
+    };
+
+    // Drop operations not kept.
+    auto compact = [&](const std::vector<uint8_t>& keep)
+    {
+        size_t removed{};
+        std::vector<Netlist::Op> kept;
+        for (size_t i = 0; i < ops.size(); ++i) {
+            if (keep[i]) {
+                kept.push_back(ops[i]);
+            } else {
+                removed++;
+            }
+        }
+        ops = std::move(kept);
+        return removed;
+    };
+
+    auto is_not = [](const Netlist::Op& op)
+    {
+        return op.code == Netlist::NAND && op.a == op.b;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        // Constant propagation, in order, so that a folded output is constant for every later operation.
+        // A signal read before its writer keeps its initial value for the first pass,
+        // so it is only folded if that equals the constant.
+        connect();
+        std::vector<uint8_t> constant(count);
+        for (size_t s = 0; s < count; ++s) {
+            constant[s] = writers[s].empty() && !input[s];
+        }
+
+        std::vector<uint8_t> keep(ops.size(), 1);
+        for (uint32_t i = 0; i < ops.size(); ++i) {
+            auto& op = ops[i];
+            if (!constant[op.a] && !constant[op.b]) {
+                continue;
+            }
+
+            bool folds{};
+            uint8_t value{};
+            if (constant[op.a] && constant[op.b]) {
+                folds = true;
+                value = Netlist::apply(op.code, initial[op.a], initial[op.b]);
+            } else {
+                uint32_t other = constant[op.a] ? op.b : op.a;
+                uint8_t k = initial[constant[op.a] ? op.a : op.b];
+                uint8_t r0 = Netlist::apply(op.code, k, 0);
+                uint8_t r1 = Netlist::apply(op.code, k, 1);
+                if (r0 == r1) {
+                    folds = true;
+                    value = r0;
+                } else {
+                    op = Netlist::Op{r1 ? Netlist::CONNECT : Netlist::NAND, other, other, op.out};
+                    changed = true;
+                }
+            }
+
+            const uint32_t s = op.out;
+            if (folds && writers[s].size() == 1 && !input[s] &&
+                (initial[s] == value || (!observed[s] && (readers[s].empty() || readers[s].front() > i)))) {
+                keep[i] = 0;
+                constant[s] = 1;
+                initial[s] = value;
+                changed = true;
+            }
+        }
+        folded_ += compact(keep);
+
+        // Double inversions.
+        // Operation p, writing a signal read only by operation i, is merged into i,
+        // provided the inputs of p are not written in between.
+        connect();
+        keep.assign(ops.size(), 1);
+        std::vector<uint8_t> touched(ops.size());
+        auto mergeable = [&](uint32_t s, uint32_t i)
+        {
+            if (writers[s].size() != 1 || observed[s] || readers[s].size() != 1) {
+                return false;
+            }
+            uint32_t p = writers[s][0];
+            if (p >= i || touched[p] || readers[s][0] != i) {
+                return false;
+            }
+            for (auto x : {ops[p].a, ops[p].b}) {
+                for (auto w : writers[x]) {
+                    if (w > p && w < i) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        };
+
+        for (uint32_t i = 0; i < ops.size(); ++i) {
+            auto& op = ops[i];
+            if (touched[i]) {
+                continue;
+            }
+
+            if (op.a == op.b && (op.code == Netlist::CONNECT || op.code == Netlist::NAND) && mergeable(op.a, i)) {
+                // Connector or NOT of operation p.
+                uint32_t p = writers[op.a][0];
+                const auto& q = ops[p];
+                Netlist::Opcode code = q.code;
+                if (op.code == Netlist::NAND) {
+                    if (q.code == Netlist::OR) {
+                        continue;
+                    }
+                    code = (q.code == Netlist::NAND ? Netlist::AND : Netlist::NAND);
+                }
+                if (code == Netlist::AND && q.a == q.b) {
+                    code = Netlist::CONNECT;
+                }
+                op = Netlist::Op{code, q.a, q.b, op.out};
+                keep[p] = 0;
+                touched[p] = touched[i] = 1;
+                collapsed_++;
+                changed = true;
+            } else if (op.code == Netlist::NAND && op.a != op.b && mergeable(op.a, i) && mergeable(op.b, i)) {
+                // NAND of two NOTs.
+                uint32_t p1 = writers[op.a][0];
+                uint32_t p2 = writers[op.b][0];
+                if (!is_not(ops[p1]) || !is_not(ops[p2])) {
+                    continue;
+                }
+                op = Netlist::Op{Netlist::OR, ops[p1].a, ops[p2].a, op.out};
+                keep[p1] = keep[p2] = 0;
+                touched[p1] = touched[p2] = touched[i] = 1;
+                collapsed_ += 2;
+                changed = true;
+            }
+        }
+        compact(keep);
+
+        // Shared operations (structural hashing).
+        // An operation identical to an earlier one, whose inputs are not written in between,
+        // is removed, and later reads of its output read the earlier output instead.
+        // Its output must not be read before it is written.
+        connect();
+        keep.assign(ops.size(), 1);
+        std::vector<uint32_t> alias(count);
+        std::iota(alias.begin(), alias.end(), 0);
+        std::vector<uint32_t> last_write(count, none);
+        std::map<std::tuple<Netlist::Opcode, uint32_t, uint32_t>, uint32_t> seen;
+        for (uint32_t i = 0; i < ops.size(); ++i) {
+            auto& op = ops[i];
+            op.a = alias[op.a];
+            op.b = alias[op.b];
+
+            auto key = std::make_tuple(op.code, std::min(op.a, op.b), std::max(op.a, op.b));
+            auto it = seen.find(key);
+            if (it != seen.end()) {
+                uint32_t j = it->second;
+                uint32_t s = ops[j].out;
+                auto unchanged = [&](uint32_t x)
+                {
+                    return last_write[x] == none || last_write[x] < j;
+                };
+                if (unchanged(op.a) && unchanged(op.b) && writers[s].size() == 1 &&
+                    writers[op.out].size() == 1 && !observed[op.out] && op.a != op.out && op.b != op.out &&
+                    (readers[op.out].empty() || readers[op.out].front() > i)) {
+                    alias[op.out] = s;
+                    keep[i] = 0;
+                    changed = true;
+                    continue;
+                }
+            }
+
+            seen[key] = i;
+            last_write[op.out] = i;
+        }
+        shared_ += compact(keep);
+
+        // Dead operations: only operations that can reach a port are live.
+        connect();
+        std::vector<uint8_t> live(count);
+        std::vector<uint32_t> work;
+        for (uint32_t s = 0; s < count; ++s) {
+            if (observed[s]) {
+                live[s] = 1;
+                work.push_back(s);
+            }
+        }
+
+        keep.assign(ops.size(), 0);
+        while (!work.empty()) {
+            uint32_t s = work.back();
+            work.pop_back();
+            for (auto w : writers[s]) {
+                if (keep[w]) {
+                    continue;
+                }
+                keep[w] = 1;
+                for (auto x : {ops[w].a, ops[w].b}) {
+                    if (!live[x]) {
+                        live[x] = 1;
+                        work.push_back(x);
+                    }
+                }
+            }
+        }
+
+        size_t removed = compact(keep);
+        eliminated_ += removed;
+        changed = changed || removed;
+    }
+
+    netlist_ = Netlist{n, std::move(ops), std::move(initial)};
+}
+
+void Optimization::print(FILE* f) const
+{
+    fprintf(f, "operations: %zu -> %zu\n", before_, after());
+    fprintf(f, "  folded: %zu\n", folded_);
+    fprintf(f, "  collapsed: %zu\n", collapsed_);
+    fprintf(f, "  shared: %zu\n", shared_);
+    fprintf(f, "  eliminated: %zu\n", eliminated_);
+}
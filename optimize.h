@@ -0,0 +1,80 @@
+#pragma once
+
+#include "netlist.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// Netlist optimization.
+/// Rewrites a netlist into one with fewer operations and the same observable behaviour:
+/// after every pass, each port has the value it would have with the original netlist.
+///
+/// Ports named in @c inputs may be changed between passes. Every other signal without a writer is a constant.
+///
+/// These rewrites are repeated until none applies:
+/// - constant propagation: an operation with a constant input is simplified, or removed if its output is constant;
+/// - double inversion: NAND then NOT becomes AND, NOTs feeding a NAND become OR, and NOT of NOT becomes a connector;
+/// - structural hashing: an operation computing the same function of the same unchanged inputs
+///   as an earlier operation is removed, and its readers read the earlier output;
+/// - dead operations: an operation whose output cannot reach a port is removed.
+///
+/// Signal indices are unchanged, but a folded signal may take its constant value as initial value,
+/// so state must be initialized from netlist().initial().
+class Optimization
+{
+    Netlist netlist_;
+    size_t before_;
+    size_t folded_;
+    size_t collapsed_;
+    size_t shared_;
+    size_t eliminated_;
+
+public:
+    Optimization(const Netlist& n, const std::vector<std::string>& inputs);
+
+    /// @return Optimized netlist.
+    const Netlist& netlist() const
+    {
+        return netlist_;
+    }
+
+    /// @return Number of operations before optimization.
+    size_t before() const
+    {
+        return before_;
+    }
+
+    /// @return Number of operations after optimization.
+    size_t after() const
+    {
+        return netlist_.ops().size();
+    }
+
+    /// @return Number of operations removed by constant propagation.
+    size_t folded() const
+    {
+        return folded_;
+    }
+
+    /// @return Number of operations removed by collapsing double inversions.
+    size_t collapsed() const
+    {
+        return collapsed_;
+    }
+
+    /// @return Number of operations removed by structural hashing.
+    size_t shared() const
+    {
+        return shared_;
+    }
+
+    /// @return Number of dead operations removed.
+    size_t eliminated() const
+    {
+        return eliminated_;
+    }
+
+    /// Print summary.
+    void print(FILE* f) const;
+};
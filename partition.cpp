@@ -0,0 +1,219 @@
+#include "partition.h"
+
+#include <algorithm>
+#include <numeric>
+
+/// Smallest share of a level worth giving to another partition.
+static const size_t GRAIN = 32;
+
+PartitionedInterpreter::PartitionedInterpreter(const Netlist& n, unsigned partitions) :
+    levels_{},
+    cross_{},
+    state_{},
+    generation_{},
+    arrived_{},
+    phase_{},
+    stop_{}
+{
+    if (partitions == 0) {
+        partitions = std::max(1u, std::thread::hardware_concurrency());
+    }
+    partitions = std::min(partitions, 64u);
+
+    const auto& ops = n.ops();
+    const size_t count = ops.size();
+    const uint32_t none = ~uint32_t{};
+
+    // Levels and dependencies, in recorded order.
+    std::vector<uint32_t> level(count);
+    std::vector<std::vector<uint32_t>> deps(count);
+    std::vector<uint32_t> after_write(n.signals());
+    std::vector<uint32_t> after_read(n.signals());
+    std::vector<uint32_t> writer(n.signals(), none);
+    std::vector<std::vector<uint32_t>> readers(n.signals());
+    for (uint32_t i = 0; i < count; ++i) {
+        const auto& op = ops[i];
+        uint32_t l = std::max({after_write[op.a], after_write[op.b], after_write[op.out], after_read[op.out]});
+        level[i] = l;
+        levels_ = std::max(levels_, static_cast<size_t>(l) + 1);
+
+        for (auto s : {op.a, op.b, op.out}) {
+            if (writer[s] != none) {
+                deps[i].push_back(writer[s]);
+            }
+        }
+        deps[i].insert(deps[i].end(), readers[op.out].begin(), readers[op.out].end());
+
+        after_read[op.a] = std::max(after_read[op.a], l + 1);
+        after_read[op.b] = std::max(after_read[op.b], l + 1);
+        readers[op.a].push_back(i);
+        if (op.b != op.a) {
+            readers[op.b].push_back(i);
+        }
+        after_write[op.out] = l + 1;
+        writer[op.out] = i;
+        readers[op.out].clear();
+    }
+
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t x, uint32_t y)
+    {
+        return level[x] < level[y];
+    });
+
+    // Partitions, level by level.
+    std::vector<uint32_t> part(count);
+    std::vector<uint32_t> writer_part(n.signals(), none);
+    for (size_t begin = 0; begin < count;) {
+        size_t end = begin;
+        while (end < count && level[order[end]] == level[order[begin]]) {
+            end++;
+        }
+
+        const size_t cap = std::max((end - begin + partitions - 1) / partitions, GRAIN);
+        std::vector<size_t> load(partitions);
+        for (size_t k = begin; k < end; ++k) {
+            const auto& op = ops[order[k]];
+            uint32_t p = writer_part[op.a] != none ? writer_part[op.a] : writer_part[op.b];
+            if (p == none || load[p] >= cap) {
+                p = static_cast<uint32_t>(std::min_element(load.begin(), load.end()) - load.begin());
+            }
+            part[order[k]] = p;
+            load[p]++;
+        }
+        for (size_t k = begin; k < end; ++k) {
+            writer_part[ops[order[k]].out] = part[order[k]];
+        }
+        begin = end;
+    }
+
+    // Segments: a barrier is needed before a level that depends on another partition since the last barrier.
+    parts_.resize(partitions);
+    uint32_t segment_level{};
+    for (size_t begin = 0; begin < count;) {
+        size_t end = begin;
+        while (end < count && level[order[end]] == level[order[begin]]) {
+            end++;
+        }
+
+        bool needed = false;
+        for (size_t k = begin; k < end && !needed; ++k) {
+            for (auto d : deps[order[k]]) {
+                if (part[d] != part[order[k]] && level[d] >= segment_level) {
+                    needed = true;
+                    break;
+                }
+            }
+        }
+        if (needed) {
+            segment_level = level[order[begin]];
+            for (auto& p : parts_) {
+                p.segment.push_back(static_cast<uint32_t>(p.out.size()));
+            }
+        }
+
+        for (size_t k = begin; k < end; ++k) {
+            const auto& op = ops[order[k]];
+            auto& p = parts_[part[order[k]]];
+            p.a.push_back(op.a);
+            p.b.push_back(op.b);
+            p.out.push_back(op.out);
+            p.invert_in.push_back(op.code == Netlist::OR ? 1 : 0);
+            p.invert_out.push_back(op.code == Netlist::NAND || op.code == Netlist::OR ? 1 : 0);
+        }
+        begin = end;
+    }
+    for (auto& p : parts_) {
+        p.segment.insert(p.segment.begin(), 0);
+        p.segment.push_back(static_cast<uint32_t>(p.out.size()));
+    }
+
+    // Signals written in one partition and read in another.
+    std::vector<uint64_t> written_by(n.signals());
+    std::vector<uint64_t> read_by(n.signals());
+    for (uint32_t i = 0; i < count; ++i) {
+        written_by[ops[i].out] |= uint64_t{1} << part[i];
+        read_by[ops[i].a] |= uint64_t{1} << part[i];
+        read_by[ops[i].b] |= uint64_t{1} << part[i];
+    }
+    for (size_t s = 0; s < n.signals(); ++s) {
+        if (written_by[s] && (read_by[s] & ~written_by[s])) {
+            cross_++;
+        }
+    }
+
+    for (size_t p = 1; p < parts_.size(); ++p) {
+        threads_.emplace_back(&PartitionedInterpreter::work, this, p);
+    }
+}
+
+PartitionedInterpreter::~PartitionedInterpreter()
+{
+    stop_ = true;
+    generation_.fetch_add(1, std::memory_order_release);
+    for (auto& t : threads_) {
+        t.join();
+    }
+}
+
+void PartitionedInterpreter::barrier()
+{
+    unsigned phase = phase_.load(std::memory_order_acquire);
+    if (arrived_.fetch_add(1, std::memory_order_acq_rel) + 1 == parts_.size()) {
+        arrived_.store(0, std::memory_order_relaxed);
+        phase_.store(phase + 1, std::memory_order_release);
+        return;
+    }
+    while (phase_.load(std::memory_order_acquire) == phase) {
+        std::this_thread::yield();
+    }
+}
+
+void PartitionedInterpreter::run(size_t part)
+{
+    const Part& p = parts_[part];
+    uint8_t* state = state_;
+
+    for (size_t k = 0; k + 1 < p.segment.size(); ++k) {
+        for (size_t i = p.segment[k]; i < p.segment[k + 1]; ++i) {
+            state[p.out[i]] = static_cast<uint8_t>(((state[p.a[i]] ^ p.invert_in[i]) & (state[p.b[i]] ^ p.invert_in[i])) ^ p.invert_out[i]);
+        }
+        if (parts_.size() > 1) {
+            barrier();
+        }
+    }
+}
+
+void PartitionedInterpreter::work(size_t part)
+{
+    unsigned seen{};
+    for (;;) {
+        while (generation_.load(std::memory_order_acquire) == seen) {
+            std::this_thread::yield();
+        }
+        seen++;
+        if (stop_) {
+            return;
+        }
+        run(part);
+    }
+}
+
+void PartitionedInterpreter::evaluate(uint8_t* state)
+{
+    state_ = state;
+    generation_.fetch_add(1, std::memory_order_release);
+    run(0);
+}
+
+void PartitionedInterpreter::print(FILE* f) const
+{
+    fprintf(f, "partitions: %zu\n", parts_.size());
+    fprintf(f, "levels: %zu\n", levels_);
+    fprintf(f, "barriers per pass: %zu\n", barriers());
+    fprintf(f, "cross-partition signals: %zu\n", cross_);
+    for (size_t p = 0; p < parts_.size(); ++p) {
+        fprintf(f, "  partition %zu: %zu operations\n", p, parts_[p].out.size());
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "netlist.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+/// Partitioned multi-threaded interpreter for a netlist.
+/// Gives the same result as Interpreter, with the operations of each pass split over several threads.
+///
+/// Operations are levelled in recorded order: an operation is placed one level after every earlier operation
+/// it must follow (writer of an input, reader or writer of its output), so operations of one level are independent.
+/// Within each level, operations are assigned to partitions by connectivity, preferring the partition
+/// that wrote their inputs, subject to a balanced share of the level.
+///
+/// Each partition is evaluated by its own thread, in level order.
+/// Threads synchronize at a barrier before a level only if it depends on another partition since the last barrier.
+class PartitionedInterpreter
+{
+    /// Operations of one partition, structure of arrays as in Interpreter.
+    struct Part
+    {
+        std::vector<uint32_t> a;
+        std::vector<uint32_t> b;
+        std::vector<uint32_t> out;
+        std::vector<uint8_t> invert_in;
+        std::vector<uint8_t> invert_out;
+        /// Operations of segment k are [segment[k], segment[k + 1]).
+        std::vector<uint32_t> segment;
+    };
+
+    std::vector<Part> parts_;
+    size_t levels_;
+    size_t cross_;
+
+    std::vector<std::thread> threads_;
+    uint8_t* state_;
+    std::atomic<unsigned> generation_;
+    std::atomic<unsigned> arrived_;
+    std::atomic<unsigned> phase_;
+    bool stop_;
+
+    void barrier();
+    void run(size_t part);
+    void work(size_t part);
+
+public:
+    /// Split @c n into @c partitions partitions, or one per core if zero.
+    explicit PartitionedInterpreter(const Netlist& n, unsigned partitions = 0);
+    PartitionedInterpreter(const PartitionedInterpreter&) = delete;
+    PartitionedInterpreter& operator=(const PartitionedInterpreter&) = delete;
+    ~PartitionedInterpreter();
+
+    /// Evaluate all operations once.
+    void evaluate(uint8_t* state);
+
+    /// @return Number of partitions (threads).
+    size_t partitions() const
+    {
+        return parts_.size();
+    }
+
+    /// @return Number of levels.
+    size_t levels() const
+    {
+        return levels_;
+    }
+
+    /// @return Number of barriers per pass.
+    size_t barriers() const
+    {
+        return parts_[0].segment.size() - 1;
+    }
+
+    /// @return Number of signals written in one partition and read in another.
+    size_t cross() const
+    {
+        return cross_;
+    }
+
+    /// Print summary.
+    void print(FILE* f) const;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "nand.cpp"
+
+#include <cstdint>
+#include <vector>
+
+/// Exercises RAM, all ALU operations and an unconditional jump.
+static std::vector<uint16_t> memory_program()
+{
+    return {
+        /*00*/ 0x0005,
+        /*01*/ OP_ADD | ZX | DEST_D, // D = A
+        /*02*/ 0x0002,
+        /*03*/ OP_ADD | ZX | SW | DEST_PA, // *A = D
+        /*04*/ SM | OP_INC | SW | DEST_D, // D = *A + 1
+        /*05*/ SM | OP_XOR | DEST_PA, // *A = D ^ *A
+        /*06*/ SM | OP_OR | DEST_D, // D = D | *A
+        /*07*/ OP_NOT | DEST_A | DEST_D, // A = D = ~D
+        /*08*/ 0x0003,
+        /*09*/ OP_SUB | SW | DEST_PA, // *A = A - D
+        /*0a*/ SM | OP_AND | DEST_D, // D = D & *A
+        /*0b*/ OP_DEC | SW | DEST_A, // A = A - 1
+        /*0c*/ 0x0002,
+        /*0d*/ SM | OP_ADD | DEST_PA, // *A = D + *A
+        /*0e*/ 0x0000,
+        /*0f*/ ALWAYS, // JMP 0
+    };
+}
+
+/// Pseudo-random program.
+static std::vector<uint16_t> random_program(uint32_t seed)
+{
+    std::vector<uint16_t> program;
+    for (size_t i = 0; i < 16; ++i) {
+        seed = seed * 1103515245 + 12345;
+        program.push_back(static_cast<uint16_t>(seed >> 16));
+    }
+    return program;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "fast.cpp"
+#include "nand.cpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/// Sampled simulation.
+/// Fast-forwards with the instruction-level FastComputer, then loads its architectural state into the gate-level
+/// Computer and simulates a detailed window, then hands the state back, and so on until halt.
+/// Each detailed window is also replayed by FastComputer from the same state, and a difference is counted as a mismatch;
+/// the run continues from the state of the gates.
+class SampledSimulation
+{
+    Signal clk_;
+    Signal fast_halt_;
+    Signal gate_halt_;
+    FastComputer fast_;
+    Computer gate_;
+    uint64_t skip_;
+    uint64_t window_;
+    uint64_t fast_cycles_;
+    uint64_t gate_cycles_;
+    uint64_t windows_;
+    uint64_t mismatches_;
+    bool halted_;
+
+public:
+    /// Simulate @c program, alternating @c skip cycles of FastComputer with @c window cycles of Computer.
+    /// Without @c skip, every cycle is run by Computer.
+    SampledSimulation(std::vector<uint16_t>& program, uint64_t skip, uint64_t window) :
+        fast_{program, clk_, fast_halt_},
+        gate_{program, clk_, gate_halt_},
+        skip_{skip},
+        window_{skip ? window : std::max<uint64_t>(window, 1)},
+        fast_cycles_{},
+        gate_cycles_{},
+        windows_{},
+        mismatches_{},
+        halted_{}
+    {
+    }
+
+    /// Run until halt, or at most @c cycles clock cycles.
+    void run(uint64_t cycles)
+    {
+        uint64_t end = this->cycles() + cycles;
+        while (!halted_ && this->cycles() < end) {
+            uint64_t n = fast_.run(std::min(skip_, end - this->cycles()));
+            fast_cycles_ += n;
+            halted_ = n && fast_halt_.get();
+            if (halted_ || this->cycles() == end || window_ == 0) {
+                continue;
+            }
+
+            // Detailed window.
+            gate_.set_state(fast_.state());
+            uint64_t limit = std::min(window_, end - this->cycles());
+            n = 0;
+            do {
+                clk_.set(1);
+                gate_.update();
+                clk_.set(0);
+                gate_.update();
+                n++;
+            } while (n < limit && !gate_halt_.get());
+            gate_cycles_ += n;
+            windows_++;
+            halted_ = gate_halt_.get();
+
+            // Replay.
+            uint64_t replayed = fast_.run(n);
+            auto s = gate_.state();
+            auto r = fast_.state();
+            if (replayed != n || fast_halt_.get() != gate_halt_.get() ||
+                s.pc != r.pc || s.a != r.a || s.d != r.d || s.ram != r.ram) {
+                mismatches_++;
+            }
+            fast_.set_state(s);
+        }
+    }
+
+    /// @return Number of clock cycles run.
+    uint64_t cycles() const
+    {
+        return fast_cycles_ + gate_cycles_;
+    }
+
+    /// @return Number of clock cycles run by FastComputer, excluding replays.
+    uint64_t fast_cycles() const
+    {
+        return fast_cycles_;
+    }
+
+    /// @return Number of clock cycles run by Computer.
+    uint64_t gate_cycles() const
+    {
+        return gate_cycles_;
+    }
+
+    /// @return Number of detailed windows.
+    uint64_t windows() const
+    {
+        return windows_;
+    }
+
+    /// @return Number of detailed windows whose result differs from FastComputer.
+    uint64_t mismatches() const
+    {
+        return mismatches_;
+    }
+
+    /// @return True if the program has halted.
+    bool halted() const
+    {
+        return halted_;
+    }
+
+    /// @return Architectural state.
+    ArchState state() const
+    {
+        return fast_.state();
+    }
+
+    /// Print summary.
+    void print(FILE* f) const
+    {
+        fprintf(f, "%s after %" PRIu64 " cycles (%" PRIu64 " gate-level in %" PRIu64 " windows), %" PRIu64 " mismatches\n",
+            halted_ ? "halted" : "running", cycles(), gate_cycles_, windows_, mismatches_);
+    }
+};
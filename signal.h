@@ -1,44 +1,101 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 
 /// A signal describes the inputs and outputs of gates.
+/// Its value (0 or 1) is stored in one byte, so that a set of contiguous signals is packed eight per 64-bit word.
 class Signal
 {
-    unsigned value_;
+    /// Not a character type, so that a store to a signal is not assumed to alias other objects,
+    /// and inlined gates can keep pointers and flags in registers.
+    enum class Level : uint8_t {};
+    Level value_;
 
 public:
+    /// Count of signals constructed, if instrumenting (see Census), else nullptr.
+    static inline uint64_t* constructed_{};
+
     Signal() : value_{}
     {
+        if (constructed_) {
+            ++*constructed_;
+        }
     }
 
     /// Get signal value.
     unsigned get() const
     {
-        return value_;
+        return static_cast<unsigned>(value_);
     }
 
     /// Set signal value.
     void set(unsigned value)
     {
-        value_ = (value != 0 ? 1 : 0);
+        value_ = static_cast<Level>(value != 0 ? 1 : 0);
     }
 };
 
+static_assert(sizeof(Signal) == 1, "Signal must be one byte");
+
 /// Interface to set of N signals.
+/// If the signals are contiguous in memory, getint() and setint() convert eight signals at a time.
 template <size_t N>
 class SignalN
 {
-    std::vector<Signal*> array_;
+    std::array<Signal*, N> array_;
+    Signal* contiguous_;
+
+    /// Set contiguous_ to the first signal if all N are set and consecutive in memory, else nullptr.
+    /// Compared as addresses, since the signals need not be elements of one array.
+    void find_contiguous()
+    {
+        contiguous_ = nullptr;
+        if (!array_[0]) {
+            return;
+        }
+        auto first = reinterpret_cast<uintptr_t>(array_[0]);
+        for (size_t i = 1; i < N; ++i) {
+            if (reinterpret_cast<uintptr_t>(array_[i]) != first + i * sizeof(Signal)) {
+                return;
+            }
+        }
+        contiguous_ = array_[0];
+    }
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    static const bool packed_ = (N % 8 == 0 && N <= 16);
+#else
+    static const bool packed_ = false;
+#endif
+
+    /// @return Values of eight signals at @c p, least significant first.
+    static uint16_t pack8(const Signal* p)
+    {
+        uint64_t x;
+        memcpy(&x, p, sizeof x);
+        // Moves byte i to bit 56 + i, without carries.
+        return static_cast<uint16_t>((x * 0x0102040810204080) >> 56);
+    }
+
+    /// Set eight signals at @c p from @c bits, least significant first.
+    static void unpack8(uint64_t bits, Signal* p)
+    {
+        // Bit i to bit i of byte i, then to bit 0.
+        uint64_t x = (bits * 0x0101010101010101) & 0x8040201008040201;
+        x = ((x + 0x7f7f7f7f7f7f7f7f) >> 7) & 0x0101010101010101;
+        memcpy(static_cast<void*>(p), &x, sizeof x);
+    }
 
 public:
     /// Construct empty set.
-    SignalN()
+    SignalN() :
+        array_{},
+        contiguous_{}
     {
-        for (size_t i = 0; i < N; ++i) {
-            array_.push_back(nullptr);
-        }
     }
 
     // Construct with pre-defined set.
@@ -47,6 +104,7 @@ public:
         for (size_t i = 0; i < N; ++i) {
             array_[i] = &storage[i];
         }
+        find_contiguous();
     }
 
     /// @return Number of elements.
@@ -74,14 +132,35 @@ public:
     }
 
     /// Set pointer.
+    /// Contiguity is found once the last pointer (N - 1) is set, so a set filled in order is checked once;
+    /// until then, or after any other pointer changes, the set is treated as not contiguous.
     void setptr(size_t i, Signal* s)
     {
         array_[i] = s;
+        if (i == N - 1) {
+            find_contiguous();
+        } else {
+            contiguous_ = nullptr;
+        }
+    }
+
+    /// @return First signal if the set is contiguous in memory, otherwise nullptr.
+    Signal* contiguous() const
+    {
+        return contiguous_;
     }
 
     /// Convert to integer for simulation purposes.
     uint16_t getint() const
     {
+        if (packed_ && contiguous_) {
+            uint16_t x{};
+            for (size_t i = 0; i < N; i += 8) {
+                x = static_cast<uint16_t>(x | (pack8(contiguous_ + i) << i));
+            }
+            return x;
+        }
+
         uint16_t x{};
         unsigned shift{};
         for (const auto& s : array_) {
@@ -94,6 +173,13 @@ public:
     /// Set value from integer for simulation purposes.
     void setint(uint16_t x)
     {
+        if (packed_ && contiguous_) {
+            for (size_t i = 0; i < N; i += 8) {
+                unpack8((x >> i) & 0xff, contiguous_ + i);
+            }
+            return;
+        }
+
         for (auto& s : array_) {
             s->set(x & 1);
             x >>= 1;
@@ -105,11 +191,11 @@ public:
 template <size_t N>
 class SignalSetN : public SignalN<N>
 {
-    std::vector<Signal> array_;
+    std::array<Signal, N> array_;
 
 public:
     /// Construct set of size @c N.
-    SignalSetN() : SignalN<N>(), array_{N, Signal{}}
+    SignalSetN() : SignalN<N>(), array_{}
     {
         for (size_t i = 0; i < N; ++i) {
             this->setptr(i, &array_[i]);
@@ -0,0 +1,45 @@
+#include "snapshot.h"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+void write_snapshot(const std::vector<uint8_t>& blob, const std::string& path)
+{
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        throw std::runtime_error("cannot write " + path);
+    }
+    bool ok = fwrite(blob.data(), 1, blob.size(), f) == blob.size();
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        throw std::runtime_error("cannot write " + path);
+    }
+}
+
+MappedSnapshot::MappedSnapshot(const std::string& path) :
+    base_{MAP_FAILED},
+    size_{}
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot read " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        size_ = static_cast<size_t>(st.st_size);
+        base_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base_ == MAP_FAILED) {
+        throw std::runtime_error("cannot map " + path);
+    }
+}
+
+MappedSnapshot::~MappedSnapshot()
+{
+    munmap(base_, size_);
+}
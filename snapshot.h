@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Write snapshot @c blob (see Computer::save_state()) to @c path.
+/// @throws std::runtime_error if the file cannot be written.
+void write_snapshot(const std::vector<uint8_t>& blob, const std::string& path);
+
+/// Memory-mapped snapshot file.
+/// Restored with Computer::restore_state(data(), size()) without reading the file into memory,
+/// so that many processes can start from one saved state.
+class MappedSnapshot
+{
+    void* base_;
+    size_t size_;
+
+public:
+    /// Map the file at @c path, read-only and shared.
+    /// @throws std::runtime_error if the file cannot be mapped.
+    explicit MappedSnapshot(const std::string& path);
+
+    MappedSnapshot(const MappedSnapshot&) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+    ~MappedSnapshot();
+
+    const uint8_t* data() const
+    {
+        return static_cast<const uint8_t*>(base_);
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+};
@@ -0,0 +1,127 @@
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <unistd.h>
+
+#include "batch.h"
+#include "example.cpp"
+#include "nand.cpp"
+
+/// Loops forever, counting in D and storing it at RAM[1].
+static std::vector<uint16_t> forever_program()
+{
+    return {
+        /*00*/ 0x0001,
+        /*01*/ SM | OP_INC | SW | DEST_D, // D = *A + 1
+        /*02*/ OP_ADD | ZX | SW | DEST_PA, // *A = D
+        /*03*/ 0x0000,
+        /*04*/ ALWAYS, // JMP 0
+    };
+}
+
+static void test_run()
+{
+    std::vector<BatchJob> jobs;
+    for (unsigned i = 0; i < 12; ++i) {
+        jobs.push_back(BatchJob{"job" + std::to_string(i), i % 3 ? example_program() : forever_program()});
+    }
+
+    auto results = run_batch(jobs, 30, 4);
+    assert(results.size() == jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const auto& r = results[i];
+        assert(r.ram.size() == 16);
+
+        if (i % 3) {
+            assert(r.halted);
+            assert(r.cycles == 8);
+            assert(r.pc == 5);
+            assert(r.d == 0);
+        } else {
+            assert(!r.halted);
+            assert(r.cycles == 30);
+            assert(r.ram[1] == 6);
+        }
+
+        // Same as a single Computer.
+        auto program = jobs[i].program;
+        program.resize(16);
+        Signal clk;
+        Signal halt;
+        Computer g{program, clk, halt};
+        for (uint64_t cycle = 0; cycle < r.cycles; ++cycle) {
+            clk.set(1);
+            g.update();
+            clk.set(0);
+            g.update();
+        }
+        assert(g.pc() == r.pc);
+        assert(g.a() == r.a);
+        assert(g.d() == r.d);
+        assert(g.pa() == r.pa);
+        for (size_t address = 0; address < 16; ++address) {
+            assert(g.ram(address) == r.ram[address]);
+        }
+    }
+
+    // Any number of threads gives the same results.
+    auto serial = run_batch(jobs, 30, 1);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        assert(serial[i].pc == results[i].pc);
+        assert(serial[i].ram == results[i].ram);
+    }
+
+    assert(run_batch({}, 30, 0).empty());
+}
+
+static void test_load()
+{
+    auto dir = std::filesystem::temp_directory_path() / ("test_batch." + std::to_string(getpid()));
+    std::filesystem::create_directory(dir);
+
+    auto write = [](const std::filesystem::path& path, const std::vector<uint8_t>& bytes)
+    {
+        FILE* f = fopen(path.c_str(), "wb");
+        assert(f);
+        fwrite(bytes.data(), 1, bytes.size(), f);
+        fclose(f);
+    };
+
+    write(dir / "b", {0x04, 0x00, 0x90, 0x84});
+    write(dir / "a", {0x00, 0xc0});
+
+    auto jobs = load_batch(dir.string());
+    assert(jobs.size() == 2);
+    assert(jobs[0].name == (dir / "a").string());
+    assert(jobs[0].program.size() == 16);
+    assert(jobs[0].program[0] == HALT);
+    assert(jobs[1].program[0] == 0x0004);
+    assert(jobs[1].program[1] == 0x8490);
+    assert(jobs[1].program[2] == 0);
+
+    std::vector<uint8_t> packed(64);
+    packed[32] = 0x00;
+    packed[33] = 0xc0;
+    write(dir / "packed", packed);
+    jobs = load_batch((dir / "packed").string());
+    assert(jobs.size() == 2);
+    assert(jobs[1].program[0] == HALT);
+    assert(run_batch(jobs, 100, 2)[1].halted);
+
+    write(dir / "bad", {1, 2, 3});
+    bool thrown = false;
+    try {
+        load_batch((dir / "bad").string());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::filesystem::remove_all(dir);
+}
+
+int main()
+{
+    test_run();
+    test_load();
+}
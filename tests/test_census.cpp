@@ -0,0 +1,58 @@
+#include <cassert>
+
+#include "census.h"
+#include "nand.cpp"
+
+// Linking census.o replaces the global operator new and delete, so the census is tested in its own program:
+// the other tests keep the allocator of the sanitizers.
+
+static void test_census()
+{
+    {
+        Signal a;
+        Signal b;
+        Signal out;
+        auto c = census<AndGate>(a, b, out);
+        const auto& classes = c.first->classes();
+        assert(classes.size() == 3);
+        assert(classes.at("AndGate") == 1);
+        assert(classes.at("NandGate") == 2);
+        assert(classes.at("NotGate") == 1);
+        assert(c.first->gates() == 4);
+        assert(c.first->signals() == 1);
+        assert(c.first->allocations() == 1);
+        assert(c.first->bytes() == sizeof(AndGate));
+        assert(c.first->live_bytes() == sizeof(AndGate));
+    }
+
+    {
+        Signal st;
+        SignalSet16 in;
+        Signal clk;
+        SignalSet16 out;
+        auto c = census<Register>(st, in, clk, out);
+        assert(c.first->classes().at("Register") == 1);
+        assert(c.first->classes().at("DataFlipFlop") == 16);
+        // Flip-flops are stored inline.
+        assert(c.first->allocations() == 1);
+        assert(c.first->bytes() == sizeof(Register));
+        assert(c.first->live_bytes() == sizeof(Register));
+    }
+
+    {
+        // Not counted when inactive.
+        Census c;
+        c.stop();
+        Signal a;
+        Signal b;
+        Signal out;
+        AndGate g{a, b, out};
+        assert(c.gates() == 0);
+        assert(c.signals() == 0);
+    }
+}
+
+int main()
+{
+    test_census();
+}
@@ -1,7 +1,12 @@
+#include <atomic>
 #include <cassert>
 #include <cstdio>
+#include <cstring>
+#include <thread>
+#include <type_traits>
 
 #include "nand.cpp"
+#include "snapshot.h"
 
 static void test_fundamental()
 {
@@ -143,6 +148,48 @@ static void test_fundamental()
 
 static void test_fundamental_multi()
 {
+    {
+        // Packed conversion of contiguous signals, and bit by bit otherwise.
+        SignalSet16 s;
+        Signal16 same;
+        Signal16 reversed;
+        for (size_t i = 0; i < 16; ++i) {
+            same.setptr(i, s.ptr(i));
+            reversed.setptr(i, s.ptr(15 - i));
+        }
+        assert(s.contiguous() && same.contiguous() == s.contiguous());
+        assert(!reversed.contiguous());
+
+        // Contiguity is found when the last pointer is set, and lost when any other changes.
+        Signal16 partial;
+        partial.setptr(5, s.ptr(5));
+        assert(!partial.contiguous());
+        for (size_t i = 0; i < 15; ++i) {
+            partial.setptr(i, s.ptr(i));
+            assert(!partial.contiguous());
+        }
+        partial.setptr(15, s.ptr(15));
+        assert(partial.contiguous() == s.ptr(0));
+        Signal other;
+        partial.setptr(3, &other);
+        assert(!partial.contiguous());
+        partial.setptr(3, s.ptr(3));
+        assert(!partial.contiguous());
+        partial.setptr(15, s.ptr(15));
+        assert(partial.contiguous() == s.ptr(0));
+
+        for (uint32_t x = 0; x < 0x10000; x += 0x0101) {
+            s.setint(static_cast<uint16_t>(x));
+            for (size_t i = 0; i < 16; ++i) {
+                assert(s.get(i) == ((x >> i) & 1));
+                assert(reversed.get(15 - i) == ((x >> i) & 1));
+            }
+            assert(same.getint() == x);
+            reversed.setint(static_cast<uint16_t>(x));
+            assert(reversed.getint() == x);
+        }
+    }
+
     {
         SignalSet16 s;
         assert(s.size() == 16);
@@ -312,6 +359,20 @@ static void test_fundamental_multi()
 	test(0x40      | 0x10, 5, 0);
 	test(     0x20,        5, 1);
     }
+
+    {
+        SignalSet16 in;
+        SignalSet16 hot;
+        Signal out;
+        OneHotMux16to1Gate g{in, hot, out};
+        in.setint(0x0020);
+        hot.setint(0x0020);
+        g.update();
+        assert(out.get() == 1);
+        hot.setint(0x0010);
+        g.update();
+        assert(out.get() == 0);
+    }
 }
 
 static void test_latch()
@@ -869,6 +930,471 @@ static void test_memory()
     }
 }
 
+static void test_state_injection()
+{
+    {
+        Signal st;
+        Signal d;
+        Signal clk;
+        Signal out;
+        DataFlipFlop g{st, d, clk, out};
+        g.set(1);
+        assert(out.get() == 1);
+        g.update();
+        assert(out.get() == 1);
+        clk.set(1);
+        g.update();
+        clk.set(0);
+        g.update();
+        assert(out.get() == 1);
+    }
+
+    {
+        Signal sel;
+        SignalSet16 x;
+        Signal clk;
+        SignalSet16 out;
+        Counter g{sel, x, clk, out};
+        g.set(0x1234);
+        assert(out.getint() == 0x1234);
+        clk.set(1);
+        g.update();
+        clk.set(0);
+        g.update();
+        assert(out.getint() == 0x1235);
+    }
+
+    {
+        Signal st;
+        SignalSet16 x;
+        SignalSet16 ad;
+        Signal clk;
+        SignalSet16 out;
+        Ram16x16 g{st, x, ad, clk, out};
+        g.set(7, 0xbeef);
+        ad.setint(7);
+        g.update();
+        assert(out.getint() == 0xbeef);
+        assert(g.word(7) == 0xbeef);
+        assert(g.word(6) == 0);
+    }
+
+    {
+        // Resume the count down at "A=3", with D = 3 instead of 4 and a word in RAM.
+        std::vector<uint16_t> program{
+            0x0004,
+            OP_ADD | ZX | DEST_D,
+            0x0003,
+            OP_DEC | DEST_D | COND_LT | COND_GT,
+            HALT,
+        };
+        program.resize(16, HALT);
+        Signal clk;
+        Signal halt;
+        Computer g{program, clk, halt};
+        ArchState s{2, 4, 3, {}};
+        s.ram[3] = 0xcafe;
+        g.set_state(s);
+        assert(g.pc() == 2);
+        assert(g.a() == 4);
+        assert(g.d() == 3);
+        assert(g.pa() == 0);
+        assert(g.state().ram == s.ram);
+
+        unsigned cycles{};
+        while (!halt.get()) {
+            clk.set(1);
+            g.update();
+            clk.set(0);
+            g.update();
+            cycles++;
+        }
+        assert(cycles == 5);
+        assert(g.pc() == 5);
+        assert(g.d() == 0);
+        assert(g.pa() == 0xcafe);
+    }
+}
+
+static void test_snapshot()
+{
+    // Count down from five, storing each value at RAM[3].
+    std::vector<uint16_t> program{
+        0x0005,
+        OP_ADD | ZX | DEST_D,
+        0x0003,
+        OP_DEC | DEST_D | DEST_PA | COND_LT | COND_GT,
+        HALT,
+    };
+    program.resize(16, HALT);
+
+    // PC, A, D and *A after each cycle, until halt.
+    auto run = [](Computer& g, Signal& clk, Signal& halt)
+    {
+        std::vector<uint16_t> trace;
+        while (!halt.get()) {
+            clk.set(1);
+            g.update();
+            clk.set(0);
+            g.update();
+            trace.insert(trace.end(), {g.pc(), g.a(), g.d(), g.pa()});
+        }
+        return trace;
+    };
+
+    Signal clk;
+    Signal halt;
+    Computer g{program, clk, halt};
+    for (unsigned i = 0; i < 6; ++i) {
+        clk.set(1);
+        g.update();
+        clk.set(0);
+        g.update();
+    }
+    auto blob = g.save_state();
+    assert(blob.size() > Computer::SNAPSHOT_HEADER);
+    assert(blob.size() < Computer::SNAPSHOT_HEADER + 2048);
+    auto rest = run(g, clk, halt);
+    assert(rest.size() == 4 * 3);
+    assert(g.pa() == 0);
+
+    // Resume in the same computer.
+    g.restore_state(blob);
+    assert(!halt.get());
+    assert(run(g, clk, halt) == rest);
+
+    // Resume in another computer: the program is part of the snapshot.
+    std::vector<uint16_t> other(16, HALT);
+    Signal clk2;
+    Signal halt2;
+    Computer h{other, clk2, halt2};
+    h.restore_state(blob);
+    assert(h.rom(3) == program[3]);
+    assert(run(h, clk2, halt2) == rest);
+
+    // From a file.
+    const char* path = "test_snapshot.snap";
+    write_snapshot(blob, path);
+    {
+        MappedSnapshot m{path};
+        assert(m.size() == blob.size());
+        h.restore_state(m.data(), m.size());
+        assert(run(h, clk2, halt2) == rest);
+    }
+    remove(path);
+
+    // Not a snapshot of this structure.
+    for (size_t i : {size_t{0}, size_t{16}, blob.size()}) {
+        auto bad = blob;
+        if (i < bad.size()) {
+            bad[i] ^= 1;
+        } else {
+            bad.pop_back();
+        }
+        bool thrown{};
+        try {
+            h.restore_state(bad);
+        } catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    {
+        // Recording for a snapshot captures only this thread's gates: another thread simulates meanwhile.
+        std::atomic<bool> done{};
+        std::atomic<unsigned> runs{};
+        std::thread worker([&]
+        {
+            while (!done || runs == 0) {
+                Signal wclk;
+                Signal whalt;
+                Computer w{program, wclk, whalt};
+                for (unsigned i = 0; i < 100 && !whalt.get(); ++i) {
+                    wclk.set(1);
+                    w.update();
+                    wclk.set(0);
+                    w.update();
+                }
+                assert(whalt.get());
+                assert(w.d() == 0);
+                assert(w.ram(3) == 0);
+                runs++;
+            }
+        });
+        for (unsigned i = 0; i < 20; ++i) {
+            Signal clk3;
+            Signal halt3;
+            Computer s{program, clk3, halt3};
+            s.restore_state(blob);
+            assert(s.save_state() == blob);
+        }
+        done = true;
+        worker.join();
+    }
+
+    // Behavioral blocks have no signals to save.
+    Computer b{program, clk, halt, BEHAVIORAL_RAM};
+    bool thrown{};
+    try {
+        b.save_state();
+    } catch (const std::logic_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+/// Pseudo-random 16-bit value.
+static uint16_t next_random(uint32_t& seed)
+{
+    seed = seed * 1103515245 + 12345;
+    return static_cast<uint16_t>(seed >> 16);
+}
+
+static void test_behavioral()
+{
+    uint32_t seed = 1;
+
+    {
+        Signal u;
+        Signal op1;
+        Signal op0;
+        Signal zx;
+        Signal sw;
+        SignalSet16 x;
+        SignalSet16 y;
+        SignalSet16 out1;
+        SignalSet16 out2;
+        ArithmeticAndLogicUnit g1{u, op1, op0, zx, sw, x, y, out1};
+        BehavioralArithmeticAndLogicUnit g2{u, op1, op0, zx, sw, x, y, out2};
+        for (unsigned i = 0; i < 2000; ++i) {
+            uint16_t control = next_random(seed);
+            u.set(control & 1);
+            op1.set((control >> 1) & 1);
+            op0.set((control >> 2) & 1);
+            zx.set((control >> 3) & 1);
+            sw.set((control >> 4) & 1);
+            x.setint(next_random(seed));
+            y.setint(control & 0x20 ? next_random(seed) : x.getint());
+            g1.update();
+            g2.update();
+            assert(out1.getint() == out2.getint());
+        }
+    }
+
+    {
+        Signal lt;
+        Signal eq;
+        Signal gt;
+        Signal out1;
+        Signal out2;
+        SignalSet16 x;
+        ConditionUnit g1{lt, eq, gt, x, out1};
+        BehavioralConditionUnit g2{lt, eq, gt, x, out2};
+        for (unsigned i = 0; i < 2000; ++i) {
+            uint16_t control = next_random(seed);
+            lt.set(control & 1);
+            eq.set((control >> 1) & 1);
+            gt.set((control >> 2) & 1);
+            x.setint(control & 0x18 ? next_random(seed) : 0);
+            g1.update();
+            g2.update();
+            assert(out1.get() == out2.get());
+        }
+    }
+
+    {
+        Signal sel;
+        Signal clk;
+        SignalSet16 x;
+        SignalSet16 out1;
+        SignalSet16 out2;
+        Counter g1{sel, x, clk, out1};
+        BehavioralCounter g2{sel, x, clk, out2};
+        for (unsigned i = 0; i < 2000; ++i) {
+            uint16_t control = next_random(seed);
+            sel.set(control & 1);
+            clk.set((control >> 1) & 1);
+            x.setint(next_random(seed));
+            g1.update();
+            g2.update();
+            assert(out1.getint() == out2.getint());
+        }
+    }
+
+    {
+        Signal st;
+        Signal clk;
+        SignalSet16 x;
+        SignalSet16 ad;
+        SignalSet16 out1;
+        SignalSet16 out2;
+        Ram16x16 g1{st, x, ad, clk, out1};
+        BehavioralRam16x16 g2{st, x, ad, clk, out2};
+        for (unsigned i = 0; i < 2000; ++i) {
+            uint16_t control = next_random(seed);
+            st.set(control & 1);
+            clk.set((control >> 1) & 1);
+            x.setint(next_random(seed));
+            ad.setint(next_random(seed));
+            g1.update();
+            g2.update();
+            assert(out1.getint() == out2.getint());
+        }
+        for (size_t address = 0; address < 16; ++address) {
+            assert(g1.word(address) == g2.word(address));
+        }
+    }
+
+    {
+        std::vector<uint16_t> program;
+        for (size_t address = 0; address < 16; ++address) {
+            program.push_back(next_random(seed));
+        }
+        SignalSet16 ad;
+        SignalSet16 out1;
+        SignalSet16 out2;
+        Rom16x16 g1{program, ad, out1};
+        BehavioralRom16x16 g2{program, ad, out2};
+        for (unsigned i = 0; i < 100; ++i) {
+            ad.setint(next_random(seed));
+            g1.update();
+            g2.update();
+            assert(out1.getint() == out2.getint());
+        }
+    }
+
+    {
+        // A behavioral block cannot be recorded.
+        std::vector<uint16_t> program(16, HALT);
+        Signal clk;
+        Signal halt;
+        Computer g{program, clk, halt, BEHAVIORAL_ALU};
+        bool thrown{};
+        try {
+            Netlist n{g};
+        } catch (const std::logic_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(!Netlist::recording());
+    }
+}
+
+static void test_word_level()
+{
+    SignalSet16 a;
+    SignalSet16 b;
+    Signal sel;
+    SignalSet16 out_not;
+    SignalSet16 out_and;
+    SignalSet16 out_or;
+    SignalSet16 out_xor;
+    SignalSet16 out_select;
+    SignalSet16 out_mask;
+    NotNGate<16> g_not{a, out_not};
+    AndNGate<16> g_and{a, b, out_and};
+    OrNGate<16> g_or{a, b, out_or};
+    XorNGate<16> g_xor{a, b, out_xor};
+    SelectNGate<16> g_select{sel, a, b, out_select};
+    Mask1xNGate<16> g_mask{sel, b, out_mask};
+
+    // Not contiguous: bits in reverse order.
+    Signal16 reversed;
+    for (size_t i = 0; i < 16; ++i) {
+        reversed.setptr(i, a.ptr(15 - i));
+    }
+    SignalSet16 out_reversed;
+    AndNGate<16> g_reversed{reversed, b, out_reversed};
+
+    assert(a.contiguous() == a.ptr(0));
+    assert(reversed.contiguous() == nullptr);
+
+    std::vector<Gate*> gates{&g_not, &g_and, &g_or, &g_xor, &g_select, &g_mask, &g_reversed};
+    auto test = [&](uint16_t a_value, uint16_t b_value, unsigned sel_value)
+    {
+        a.setint(a_value);
+        b.setint(b_value);
+        sel.set(sel_value);
+
+        std::vector<uint16_t> word;
+        std::vector<uint16_t> nand;
+        // Signal bytes as stored, which must be 0 or 1 whichever path wrote them.
+        std::vector<uint8_t> word_bytes;
+        std::vector<uint8_t> nand_bytes;
+        for (bool enabled : {false, true}) {
+            WordLevel::enabled = enabled;
+            for (auto out : {&out_not, &out_and, &out_or, &out_xor, &out_select, &out_mask, &out_reversed}) {
+                // Stale values must not leak into the result.
+                out->setint(enabled ? 0x5a5a : 0xa5a5);
+            }
+            for (auto g : gates) {
+                g->update();
+            }
+            auto& v = enabled ? word : nand;
+            auto& bytes = enabled ? word_bytes : nand_bytes;
+            for (auto out : {&out_not, &out_and, &out_or, &out_xor, &out_select, &out_mask, &out_reversed}) {
+                v.push_back(out->getint());
+                uint8_t raw[16];
+                memcpy(raw, out->contiguous(), sizeof raw);
+                bytes.insert(bytes.end(), raw, raw + sizeof raw);
+            }
+        }
+        WordLevel::enabled = true;
+
+        assert(word == nand);
+        assert(word_bytes == nand_bytes);
+        for (auto byte : word_bytes) {
+            assert(byte <= 1);
+        }
+        assert(word[0] == static_cast<uint16_t>(~a_value));
+        assert(word[1] == (a_value & b_value));
+        assert(word[2] == (a_value | b_value));
+        assert(word[3] == (a_value ^ b_value));
+        assert(word[4] == (sel_value ? a_value : b_value));
+        assert(word[5] == (sel_value ? b_value : 0));
+    };
+
+    test(0, 0, 0);
+    test(0xffff, 0, 1);
+    test(0x1234, 0xff00, 0);
+    test(0x1234, 0xff00, 1);
+    test(0xa5a5, 0x5a5a, 1);
+
+    {
+        // Eight signals per word, then one at a time.
+        SignalSetN<12> in;
+        SignalSetN<12> out;
+        NotNGate<12> g{in, out};
+        in.setint(0x0a5c);
+        g.update();
+        assert(out.getint() == 0x05a3);
+    }
+}
+
+static void test_static_dispatch()
+{
+    // Gates held by value within composites are final, so that their update() is called directly and inlined.
+    static_assert(std::is_final_v<NandGate>);
+    static_assert(std::is_final_v<FullAdderGate>);
+    static_assert(std::is_final_v<Add16Gate>);
+    static_assert(std::is_final_v<AndNGate<16>>);
+    static_assert(std::is_final_v<Ram16x16>);
+    static_assert(!std::is_final_v<Computer>);
+
+    // The virtual interface remains at the boundary.
+    Signal a;
+    Signal b;
+    Signal out;
+    std::unique_ptr<Gate> g = std::make_unique<NandGate>(a, b, out);
+    for (unsigned x = 0; x < 4; ++x) {
+        a.set(x & 1);
+        b.set(x & 2);
+        g->update();
+        assert(out.get() == (x != 3));
+    }
+}
+
 int main()
 {
     test_fundamental();
@@ -878,4 +1404,9 @@ int main()
     test_alu();
     test_control_unit();
     test_memory();
+    test_state_injection();
+    test_snapshot();
+    test_behavioral();
+    test_word_level();
+    test_static_dispatch();
 }
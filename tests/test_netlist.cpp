@@ -0,0 +1,1097 @@
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "baked.cpp"
+#include "cosim.cpp"
+#include "example.cpp"
+#include "fast.cpp"
+#include "flat.cpp"
+#include "netfile.h"
+#include "programs.cpp"
+#include "sample.cpp"
+
+/// Run Computer and another model in lockstep, comparing state each half cycle.
+template <typename Model>
+static void compare(std::vector<uint16_t> program, unsigned cycles)
+{
+    Signal clk1;
+    Signal halt1;
+    Computer c1{program, clk1, halt1};
+
+    Signal clk2;
+    Signal halt2;
+    Model c2{program, clk2, halt2};
+
+    for (unsigned i = 0; i < 2 * cycles; ++i) {
+        assert(c1.pc() == c2.pc());
+        assert(c1.a() == c2.a());
+        assert(c1.d() == c2.d());
+        assert(c1.pa() == c2.pa());
+        assert(halt1.get() == halt2.get());
+
+        clk1.set(1 - (i & 1));
+        clk2.set(1 - (i & 1));
+        c1.update();
+        c2.update();
+    }
+}
+
+static void test_netlist()
+{
+    {
+        Signal a;
+        Signal b;
+        Signal out;
+        NandGate g{a, b, out};
+        Netlist n{g};
+        assert(n.signals() == 3);
+        assert(n.ops().size() == 1);
+        assert(n.ops()[0].code == Netlist::NAND);
+        assert(n.ops()[0].a == n.index(a));
+        assert(n.ops()[0].b == n.index(b));
+        assert(n.ops()[0].out == n.index(out));
+
+        // Recording does not evaluate.
+        assert(out.get() == 0);
+        assert(n.initial()[n.index(out)] == 0);
+    }
+
+    {
+        Signal in;
+        Signal out;
+        Connector g{in, out};
+        in.set(1);
+        Netlist n{g};
+        assert(n.ops().size() == 1);
+        assert(n.ops()[0].code == Netlist::CONNECT);
+        assert(n.initial()[n.index(in)] == 1);
+        assert(out.get() == 0);
+    }
+
+    {
+        Signal in;
+        Signal out;
+        AndGate g{in, in, out};
+        Netlist n{g};
+        assert(n.ops().size() == 2);
+    }
+}
+
+static void test_interpreter()
+{
+    SignalSet16 a;
+    SignalSet16 b;
+    Signal c;
+    SignalSet16 out;
+    Signal c_out;
+    Add16Gate g{a, b, c, out, c_out};
+    Netlist n{g};
+    n.port("a", a);
+    n.port("b", b);
+    n.port("out", out);
+    n.port("c_out", c_out);
+
+    Interpreter interpreter{n};
+    std::vector<uint8_t> state{n.initial()};
+    auto test = [&](uint16_t a_value, uint16_t b_value, uint16_t expect_out, unsigned expect_c_out)
+    {
+        for (size_t i = 0; i < 16; ++i) {
+            state[n.port("a").bits[i]] = (a_value >> i) & 1;
+            state[n.port("b").bits[i]] = (b_value >> i) & 1;
+        }
+        interpreter.evaluate(state.data());
+        uint16_t x{};
+        for (size_t i = 0; i < 16; ++i) {
+            x = static_cast<uint16_t>(x | (state[n.port("out").bits[i]] << i));
+        }
+        assert(x == expect_out);
+        assert(state[n.port("c_out").bits[0]] == expect_c_out);
+    };
+
+    test(0, 0, 0, 0);
+    test(0, 1, 1, 0);
+    test(0xfffc, 1, 0xfffd, 0);
+    test(0xffff, 1, 0x0000, 1);
+    test(65535, 65535, 65534, 1);
+}
+
+static void test_flat_computer()
+{
+    {
+        auto program = example_program();
+        Signal clk;
+        Signal halt;
+        FlatComputer g{program, clk, halt};
+        std::vector<uint16_t> trace;
+
+        while (!halt.get()) {
+            trace.push_back(g.pc());
+            trace.push_back(g.d());
+            clk.set(1);
+            g.update();
+            clk.set(0);
+            g.update();
+        }
+
+        std::vector<uint16_t> expected{0, 0, 1, 0, 2, 4, 3, 4, 3, 3, 3, 2, 3, 1, 4, 0};
+        assert(trace == expected);
+    }
+
+    compare<FlatComputer>(example_program(), 12);
+    compare<FlatComputer>(memory_program(), 40);
+}
+
+static void test_clone()
+{
+    static_assert(FlatComputer::clonable);
+    static_assert(LevelizedComputer::clonable);
+    static_assert(JitComputer::clonable);
+    static_assert(!EventComputer::clonable);
+    static_assert(!PartitionedComputer::clonable);
+
+    // PC, A, D and RAM after each of @c n cycles.
+    auto run = [](FlatComputer& g, Signal& clk, unsigned n)
+    {
+        std::vector<uint16_t> trace;
+        for (unsigned i = 0; i < n; ++i) {
+            clk.set(1);
+            g.update();
+            clk.set(0);
+            g.update();
+            trace.push_back(g.pc());
+            trace.push_back(g.a());
+            trace.push_back(g.d());
+            for (size_t address = 0; address < 16; ++address) {
+                trace.push_back(g.ram(address));
+            }
+        }
+        return trace;
+    };
+
+    auto program = memory_program();
+    Signal clk;
+    Signal halt;
+    FlatComputer g{program, clk, halt};
+    auto before = run(g, clk, 10);
+
+    // The clone continues from the same point, sharing the netlist.
+    Signal clk2;
+    Signal halt2;
+    FlatComputer c{g, clk2, halt2};
+    assert(&c.netlist() == &g.netlist());
+    assert(c.pc() == g.pc() && c.a() == g.a() && c.d() == g.d());
+    auto after = run(g, clk, 30);
+    assert(run(c, clk2, 30) == after);
+
+    // The same as without cloning.
+    Signal clk3;
+    Signal halt3;
+    FlatComputer whole{program, clk3, halt3};
+    before.insert(before.end(), after.begin(), after.end());
+    assert(run(whole, clk3, 40) == before);
+
+    // Back to a snapshot.
+    Signal clk4;
+    Signal halt4;
+    FlatComputer snapshot{g, clk4, halt4};
+    auto next = run(g, clk, 5);
+    g.assign(snapshot);
+    assert(run(g, clk, 5) == next);
+
+    // Only between clones.
+    bool thrown{};
+    try {
+        g.assign(whole);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+static void test_event_computer()
+{
+    compare<EventComputer>(example_program(), 12);
+    compare<EventComputer>(memory_program(), 40);
+    compare<EventComputer>(random_program(1), 40);
+
+    // Only the active cone is evaluated.
+    auto program = memory_program();
+    Signal clk;
+    Signal halt;
+    EventComputer g{program, clk, halt};
+    size_t ops = g.netlist().ops().size();
+    for (unsigned i = 0; i < 20; ++i) {
+        clk.set(1);
+        g.update();
+        clk.set(0);
+        g.update();
+    }
+    assert(g.engine().evaluated() > ops);
+    assert(g.engine().evaluated() < 40 * ops / 2);
+}
+
+/// Evaluates NOT before the NAND that feeds it.
+class MisorderedAndGate : public Gate
+{
+    Signal c_;
+    NandGate nand_;
+    NotGate not_;
+
+public:
+    MisorderedAndGate(Signal& a, Signal& b, Signal& out) :
+        nand_{a, b, c_},
+        not_{c_, out}
+    {
+    }
+
+    void update() override
+    {
+        not_.update();
+        nand_.update();
+    }
+};
+
+template <typename G, typename... Args>
+static size_t misordered(Args&... args)
+{
+    G g{args...};
+    Netlist n{g};
+    Levelization l{n};
+    return l.misordered().size();
+}
+
+static void test_levelization()
+{
+    {
+        Signal a;
+        Signal b;
+        Signal out;
+        MisorderedAndGate g{a, b, out};
+        Netlist n{g};
+        n.port("a", a);
+        n.port("b", b);
+        n.port("out", out);
+
+        Levelization l{n};
+        assert(l.misordered().size() == 1);
+        assert(l.misordered()[0].op == 0);
+        assert(l.misordered()[0].signal == n.ops()[1].out);
+        assert(l.loops().empty());
+        assert(l.depth() == 2);
+        assert(l.level()[0] == 1);
+        assert(l.level()[1] == 0);
+
+        // The recorded order needs two passes, the level order one.
+        std::vector<uint8_t> state{n.initial()};
+        state[n.port("a").bits[0]] = 1;
+        std::vector<uint8_t> levelized{state};
+
+        Interpreter{n}.evaluate(state.data());
+        assert(state[n.port("out").bits[0]] == 1);
+        LevelizedInterpreter{n}.evaluate(levelized.data());
+        assert(levelized[n.port("out").bits[0]] == 0);
+    }
+
+    {
+        Signal st;
+        Signal d;
+        Signal out;
+        DataLatchGate g{st, d, out};
+        Netlist n{g};
+        Levelization l{n};
+        assert(l.misordered().empty());
+        assert(l.loops().size() == 1);
+    }
+
+    {
+        Signal op1;
+        Signal op0;
+        Signal u;
+        Signal zx;
+        Signal sw;
+        Signal lt;
+        Signal eq;
+        Signal gt;
+        Signal sel;
+        Signal clk;
+        Signal out;
+        SignalSet16 x;
+        SignalSet16 y;
+        SignalSet16 out16;
+        assert((misordered<LogicUnit>(op1, op0, x, y, out16) == 0));
+        assert((misordered<ArithmeticUnit>(op1, op0, x, y, out16) == 0));
+        assert((misordered<ArithmeticAndLogicUnit>(u, op1, op0, zx, sw, x, y, out16) == 0));
+        assert((misordered<ConditionUnit>(lt, eq, gt, x, out) == 0));
+
+        // The incrementer reads each bit of the register before the register is updated.
+        assert((misordered<Counter>(sel, x, clk, out16) == 16));
+    }
+
+    {
+        auto program = memory_program();
+        Signal clk;
+        Signal halt;
+        Computer c{program, clk, halt};
+        Netlist n{c};
+        Levelization l{n};
+        assert(!l.loops().empty());
+        assert(l.depth() < n.ops().size());
+    }
+
+    compare<LevelizedComputer>(example_program(), 12);
+    compare<LevelizedComputer>(memory_program(), 40);
+    compare<LevelizedComputer>(random_program(2), 40);
+}
+
+static void test_jit()
+{
+    {
+        Signal a;
+        Signal b;
+        Signal out;
+        XorGate g{a, b, out};
+        Netlist n{g};
+        n.port("a", a);
+        n.port("b", b);
+        n.port("out", out);
+        Jit jit{n};
+#if defined(__x86_64__)
+        assert(jit.compiled());
+#endif
+        std::vector<uint8_t> state{n.initial()};
+        auto test = [&](uint8_t a_value, uint8_t b_value, uint8_t expect_out)
+        {
+            state[n.port("a").bits[0]] = a_value;
+            state[n.port("b").bits[0]] = b_value;
+            jit.evaluate(state.data());
+            assert(state[n.port("out").bits[0]] == expect_out);
+        };
+
+        test(0, 0, 0);
+        test(0, 1, 1);
+        test(1, 0, 1);
+        test(1, 1, 0);
+    }
+
+    compare<JitComputer>(example_program(), 12);
+    compare<JitComputer>(memory_program(), 40);
+    compare<JitComputer>(random_program(3), 40);
+}
+
+static void test_optimization()
+{
+    {
+        Signal a;
+        Signal b;
+        Signal out;
+        AndGate g{a, b, out};
+        Netlist n{g};
+        n.port("a", a);
+        n.port("b", b);
+        n.port("out", out);
+        Optimization o{n, {"a", "b"}};
+        assert(o.after() == 1);
+        assert(o.collapsed() == 1);
+        assert(o.netlist().ops()[0].code == Netlist::AND);
+    }
+
+    {
+        Signal a;
+        Signal b;
+        Signal out;
+        OrGate g{a, b, out};
+        Netlist n{g};
+        n.port("a", a);
+        n.port("b", b);
+        n.port("out", out);
+        Optimization o{n, {"a", "b"}};
+        assert(o.before() == 3);
+        assert(o.after() == 1);
+        assert(o.netlist().ops()[0].code == Netlist::OR);
+    }
+
+    {
+        // Every engine evaluates the new operations.
+        Signal a;
+        Signal b;
+        Signal out;
+        XorGate g{a, b, out};
+        Netlist n{g};
+        n.port("a", a);
+        n.port("b", b);
+        n.port("out", out);
+        Optimization o{n, {"a", "b"}};
+        assert(o.after() == 3);
+        const Netlist& m = o.netlist();
+
+        Jit jit{m};
+        EventInterpreter event{m};
+        for (uint8_t x = 0; x < 4; ++x) {
+            std::vector<uint8_t> state{m.initial()};
+            state[m.port("a").bits[0]] = x & 1;
+            state[m.port("b").bits[0]] = x >> 1;
+            std::vector<uint8_t> jitted{state};
+            std::vector<uint8_t> evented{state};
+            Interpreter{m}.evaluate(state.data());
+            jit.evaluate(jitted.data());
+            event.evaluate(evented.data());
+            assert(state[m.port("out").bits[0]] == ((x & 1) ^ (x >> 1)));
+            assert(jitted == state);
+            assert(evented == state);
+        }
+    }
+
+    {
+        // Unused inputs are constant: the output is folded.
+        Signal a;
+        Signal b;
+        Signal out;
+        AndGate g{a, b, out};
+        Netlist n{g};
+        n.port("out", out);
+        Optimization o{n, {}};
+        assert(o.after() == 0);
+        assert(o.folded() == 2);
+    }
+
+    {
+        // The second NAND is the same as the first.
+        Signal a;
+        Signal b;
+        Signal c1;
+        Signal c2;
+        Signal out;
+        Netlist n;
+        n.nand(a, b, c1);
+        n.nand(a, b, c2);
+        n.nand(c1, c2, out);
+        n.port("a", a);
+        n.port("b", b);
+        n.port("out", out);
+        Optimization o{n, {"a", "b"}};
+        assert(o.shared() == 1);
+        assert(o.after() == 1);
+        assert(o.netlist().ops()[0].code == Netlist::AND);
+    }
+
+    {
+        auto program = example_program();
+        Signal clk;
+        Signal halt;
+        Optimization o{flatten(program, clk, halt), {"clk"}};
+        assert(o.after() < o.before() / 2);
+        assert(o.shared() > 0);
+        assert(o.before() - o.after() == o.folded() + o.collapsed() + o.shared() + o.eliminated());
+    }
+
+    compare<OptimizedComputer>(example_program(), 12);
+    compare<OptimizedComputer>(memory_program(), 40);
+    compare<OptimizedComputer>(random_program(4), 40);
+    compare<OptimizedComputer>(random_program(5), 40);
+}
+
+static void test_partition()
+{
+    auto program = memory_program();
+    Signal clk;
+    Signal halt;
+    Netlist n = flatten(program, clk, halt);
+    Netlist m = optimize(n);
+
+    for (const Netlist* netlist : {&n, &m}) {
+        for (unsigned partitions : {1u, 3u}) {
+            Interpreter serial{*netlist};
+            PartitionedInterpreter partitioned{*netlist, partitions};
+            assert(partitioned.partitions() == partitions);
+            assert(partitioned.levels() < netlist->ops().size());
+            if (partitions == 1) {
+                assert(partitioned.cross() == 0);
+                assert(partitioned.barriers() == 1);
+            }
+
+            std::vector<uint8_t> expected{netlist->initial()};
+            std::vector<uint8_t> state{netlist->initial()};
+            uint32_t clk_index = netlist->port("clk").bits[0];
+            for (unsigned i = 0; i < 2 * 20; ++i) {
+                expected[clk_index] = state[clk_index] = static_cast<uint8_t>(1 - (i & 1));
+                serial.evaluate(expected.data());
+                partitioned.evaluate(state.data());
+                assert(state == expected);
+            }
+        }
+    }
+
+    compare<PartitionedComputer>(example_program(), 12);
+    compare<PartitionedComputer>(random_program(6), 20);
+}
+
+static void test_sliced_computer()
+{
+    std::vector<std::vector<uint16_t>> programs;
+    programs.push_back(example_program());
+    programs.push_back(memory_program());
+    while (programs.size() < SlicedComputer::LANES) {
+        programs.push_back(random_program(static_cast<uint32_t>(programs.size())));
+    }
+
+    Signal clk;
+    SlicedComputer g{programs, clk};
+
+    std::vector<std::unique_ptr<Signal>> clks;
+    std::vector<std::unique_ptr<Signal>> halts;
+    std::vector<std::unique_ptr<FlatComputer>> refs;
+    for (auto& program : programs) {
+        clks.push_back(std::make_unique<Signal>());
+        halts.push_back(std::make_unique<Signal>());
+        refs.push_back(std::make_unique<FlatComputer>(program, *clks.back(), *halts.back()));
+    }
+    std::vector<uint8_t> stopped(programs.size());
+
+    for (unsigned i = 0; i < 2 * 40; ++i) {
+        for (size_t lane = 0; lane < SlicedComputer::LANES; ++lane) {
+            assert(g.pc(lane) == refs[lane]->pc());
+            assert(g.a(lane) == refs[lane]->a());
+            assert(g.d(lane) == refs[lane]->d());
+            assert(g.pa(lane) == refs[lane]->pa());
+            assert(((g.halt() >> lane) & 1) == halts[lane]->get());
+        }
+
+        clk.set(1 - (i & 1));
+        g.update();
+        for (size_t lane = 0; lane < SlicedComputer::LANES; ++lane) {
+            // A lane halted at the start of a cycle stops.
+            stopped[lane] = stopped[lane] || (clk.get() && halts[lane]->get());
+            if (!stopped[lane]) {
+                clks[lane]->set(clk.get());
+                refs[lane]->update();
+            }
+        }
+    }
+    assert(g.halt() & 1);
+    for (size_t lane = 0; lane < SlicedComputer::LANES; ++lane) {
+        for (size_t address = 0; address < 16; ++address) {
+            assert(g.ram(lane, address) == refs[lane]->ram(address));
+            assert(g.rom(lane, address) == programs[lane][address]);
+        }
+    }
+    // The memory program stores to RAM.
+    assert(g.ram(1, 2) != 0);
+
+    // Partially filled: only lanes with a program run.
+    programs.resize(1);
+    SlicedComputer one{programs, clk};
+    assert(one.pc(0) == 0);
+    while (!one.halted()) {
+        clk.set(1);
+        one.update();
+        clk.set(0);
+        one.update();
+    }
+    assert(one.pc(0) == 5);
+    assert(one.pc(1) == 0);
+
+    // No programs, too many, or one too short.
+    auto rejected = [&](std::vector<std::vector<uint16_t>> bad)
+    {
+        try {
+            SlicedComputer g{bad, clk};
+        } catch (const std::invalid_argument&) {
+            return true;
+        }
+        return false;
+    };
+    assert(rejected({}));
+    assert(rejected(std::vector<std::vector<uint16_t>>(SlicedComputer::LANES + 1, example_program())));
+    assert(rejected({example_program(), std::vector<uint16_t>(15, HALT)}));
+    assert(!rejected(std::vector<std::vector<uint16_t>>(SlicedComputer::LANES, example_program())));
+}
+
+static void test_wide()
+{
+    // Every supported instruction set gives the same result.
+    {
+        auto program = memory_program();
+        Signal clk;
+        Signal halt;
+        Netlist n{flatten(program, clk, halt)};
+        Interpreter interpreter{n};
+        const size_t words = 8;
+
+        std::vector<uint64_t> initial;
+        uint64_t seed = 1;
+        for (size_t i = 0; i < n.signals() * words; ++i) {
+            seed = seed * 6364136223846793005 + 1442695040888963407;
+            initial.push_back(seed);
+        }
+
+        std::vector<uint64_t> expected{initial};
+        interpreter.evaluate(expected.data(), words, Interpreter::SCALAR);
+        for (auto isa : {Interpreter::AVX2, Interpreter::AVX512}) {
+            assert(Interpreter::usable(isa, words) == Interpreter::supported(isa));
+            if (Interpreter::supported(isa)) {
+                std::vector<uint64_t> state{initial};
+                interpreter.evaluate(state.data(), words, isa);
+                assert(state == expected);
+            }
+        }
+
+        // Unsupported, or not a whole number of vectors: rejected rather than faulting or overrunning the state.
+        auto rejected = [&](Interpreter::Isa isa, size_t w)
+        {
+            std::vector<uint64_t> state{initial};
+            try {
+                interpreter.evaluate(state.data(), w, isa);
+            } catch (const std::invalid_argument&) {
+                return state == initial;
+            }
+            return false;
+        };
+        assert(!Interpreter::usable(Interpreter::AVX2, 6));
+        assert(!Interpreter::usable(Interpreter::AVX512, 4));
+        assert(rejected(Interpreter::AVX2, 6));
+        assert(rejected(Interpreter::AVX512, 4));
+        for (auto isa : {Interpreter::AVX2, Interpreter::AVX512}) {
+            assert(rejected(isa, words) == !Interpreter::supported(isa));
+        }
+        assert(Interpreter::best(words) == Interpreter::AVX512 || !Interpreter::supported(Interpreter::AVX512));
+        assert(Interpreter::usable(Interpreter::best(3), 3));
+
+        Signal clk2;
+        std::vector<std::vector<uint16_t>> programs{program};
+        SlicedComputer g{programs, clk2};
+        bool thrown{};
+        try {
+            g.isa(Interpreter::AVX512);
+        } catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(g.isa() == Interpreter::SCALAR);
+
+        // Each word of a wide state is an independent 64-lane state.
+        for (size_t w = 0; w < words; ++w) {
+            std::vector<uint64_t> state;
+            for (size_t s = 0; s < n.signals(); ++s) {
+                state.push_back(initial[s * words + w]);
+            }
+            interpreter.evaluate(state.data());
+            for (size_t s = 0; s < n.signals(); ++s) {
+                assert(state[s] == expected[s * words + w]);
+            }
+        }
+    }
+
+    // 512 lanes behave as eight groups of 64.
+    std::vector<std::vector<uint16_t>> programs;
+    while (programs.size() < SlicedComputer512::LANES) {
+        auto program = random_program(static_cast<uint32_t>(programs.size()));
+        if (programs.size() % 3 == 0) {
+            program[programs.size() % 16] = HALT;
+        }
+        programs.push_back(program);
+    }
+
+    Signal clk;
+    SlicedComputer512 g{programs, clk};
+    std::vector<std::unique_ptr<SlicedComputer>> refs;
+    for (size_t group = 0; group < 8; ++group) {
+        std::vector<std::vector<uint16_t>> group_programs{programs.begin() + 64 * group, programs.begin() + 64 * (group + 1)};
+        refs.push_back(std::make_unique<SlicedComputer>(group_programs, clk));
+    }
+
+    for (unsigned i = 0; i < 2 * 40; ++i) {
+        for (size_t lane = 0; lane < SlicedComputer512::LANES; lane += 7) {
+            const auto& ref = *refs[lane / 64];
+            assert(g.pc(lane) == ref.pc(lane % 64));
+            assert(g.a(lane) == ref.a(lane % 64));
+            assert(g.d(lane) == ref.d(lane % 64));
+            assert(g.pa(lane) == ref.pa(lane % 64));
+        }
+        for (size_t w = 0; w < 8; ++w) {
+            assert(g.halt(w) == refs[w]->halt());
+        }
+
+        clk.set(1 - (i & 1));
+        g.update();
+        for (auto& ref : refs) {
+            ref->update();
+        }
+    }
+    assert(g.halt(0) != 0);
+}
+
+/// Computer with the blocks @c BEHAVIORAL simulated behaviorally.
+template <unsigned BEHAVIORAL>
+class MixedComputer : public Computer
+{
+public:
+    MixedComputer(std::vector<uint16_t>& program, Signal& clk, Signal& halt) :
+        Computer{program, clk, halt, BEHAVIORAL}
+    {
+    }
+};
+
+static void test_mixed_computer()
+{
+    const unsigned all = BEHAVIORAL_ALL;
+    for (uint32_t seed = 400; seed < 404; ++seed) {
+        compare<MixedComputer<BEHAVIORAL_ROM>>(random_program(seed), 40);
+        compare<MixedComputer<BEHAVIORAL_RAM>>(random_program(seed), 40);
+        compare<MixedComputer<BEHAVIORAL_ALU>>(random_program(seed), 40);
+        compare<MixedComputer<BEHAVIORAL_CONDITION>>(random_program(seed), 40);
+        compare<MixedComputer<BEHAVIORAL_COUNTER>>(random_program(seed), 40);
+        compare<MixedComputer<all>>(random_program(seed), 40);
+        compare<MixedComputer<all & ~BEHAVIORAL_ALU>>(random_program(seed), 40);
+    }
+    compare<MixedComputer<all>>(example_program(), 12);
+    compare<MixedComputer<all>>(memory_program(), 40);
+
+    auto program = memory_program();
+    Cosimulation<MixedComputer<all>> sim{program};
+    assert(sim.run(100));
+}
+
+static void test_fast_computer()
+{
+    compare<FastComputer>(example_program(), 12);
+    compare<FastComputer>(memory_program(), 40);
+    for (uint32_t seed = 100; seed < 132; ++seed) {
+        compare<FastComputer>(random_program(seed), 40);
+    }
+
+    // Whole cycles.
+    auto program = example_program();
+    Signal clk;
+    Signal halt;
+    FastComputer g{program, clk, halt};
+    assert(g.run(100) == 8);
+    assert(halt.get());
+    assert(g.pc() == 5);
+    assert(g.d() == 0);
+
+    program = memory_program();
+    FastComputer g1{program, clk, halt};
+    Computer g2{program, clk, halt};
+    for (unsigned i = 0; i < 40; ++i) {
+        g1.step();
+        clk.set(1);
+        g2.update();
+        clk.set(0);
+        g2.update();
+        assert(g1.pc() == g2.pc());
+        assert(g1.a() == g2.a());
+        assert(g1.d() == g2.d());
+        for (size_t address = 0; address < 16; ++address) {
+            assert(g1.ram(address) == g2.ram(address));
+        }
+    }
+}
+
+static void test_baked_computer()
+{
+    // The tables are of the example program, but any program can be loaded.
+    compare<BakedComputer>(example_program(), 12);
+    compare<BakedComputer>(memory_program(), 40);
+    for (uint32_t seed = 200; seed < 216; ++seed) {
+        compare<BakedComputer>(random_program(seed), 40);
+    }
+
+    auto program = memory_program();
+    Cosimulation<BakedComputer> c{program};
+    assert(c.run(200));
+    for (size_t address = 0; address < 16; ++address) {
+        assert(c.model().rom(address) == program[address]);
+    }
+}
+
+/// Netlist file mapped by test_netlist_file.
+static const MappedNetlist* mapped_netlist;
+
+/// MappedComputer of mapped_netlist, constructed as the other models.
+class MappedExampleComputer : public MappedComputer
+{
+public:
+    MappedExampleComputer(std::vector<uint16_t>& program, Signal& clk, Signal& halt) :
+        MappedComputer{*mapped_netlist, program, clk, halt}
+    {
+    }
+};
+
+static void test_netlist_file()
+{
+    const char* path = "test_netlist.net";
+    auto program = example_program();
+    Signal clk;
+    Signal halt;
+    Netlist n = flatten(program, clk, halt);
+    write_netlist(n, path);
+
+    {
+        MappedNetlist m{path};
+        assert(m.signals() == n.signals());
+        assert(m.operations() == n.ops().size());
+        assert(m.depth() == Levelization{n}.depth());
+        assert(m.level(0) == 0);
+        assert(m.level(m.depth()) == m.operations());
+        assert(m.ports() == n.ports().size());
+        for (const auto& p : n.ports()) {
+            const auto& q = m.port(p.name);
+            assert(q.size == p.bits.size());
+            for (size_t bit = 0; bit < q.size; ++bit) {
+                assert(m.bits(q)[bit] == p.bits[bit]);
+            }
+        }
+        for (size_t s = 0; s < m.signals(); ++s) {
+            assert(m.initial()[s] == n.initial()[s]);
+        }
+
+        // One file serves any program.
+        mapped_netlist = &m;
+        compare<MappedExampleComputer>(example_program(), 12);
+        compare<MappedExampleComputer>(memory_program(), 40);
+        for (uint32_t seed = 300; seed < 308; ++seed) {
+            compare<MappedExampleComputer>(random_program(seed), 40);
+        }
+        mapped_netlist = nullptr;
+    }
+
+    // A port of the wrong width: a valid netlist file, but not of a Computer.
+    {
+        FILE* f = fopen(path, "r+b");
+        assert(f);
+        NetfileHeader h;
+        assert(fread(&h, sizeof h, 1, f) == 1);
+        for (uint64_t i = 0; i < h.ports; ++i) {
+            NetfilePort p;
+            long offset = static_cast<long>(h.ports_offset + i * sizeof p);
+            assert(fseek(f, offset, SEEK_SET) == 0);
+            assert(fread(&p, sizeof p, 1, f) == 1);
+            if (std::string{p.name} == "pc") {
+                p.size = 17;
+                assert(p.offset + p.size <= h.bits);
+                assert(fseek(f, offset, SEEK_SET) == 0);
+                assert(fwrite(&p, sizeof p, 1, f) == 1);
+            }
+        }
+        fclose(f);
+
+        MappedNetlist m{path};
+        assert(m.port("pc").size == 17);
+        Signal clk;
+        Signal halt;
+        bool thrown{};
+        try {
+            MappedComputer g{m, program, clk, halt};
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    // Truncated.
+    FILE* f = fopen(path, "r+b");
+    assert(f);
+    assert(ftruncate(fileno(f), 4096) == 0);
+    fclose(f);
+    bool thrown{};
+    try {
+        MappedNetlist m{path};
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    remove(path);
+}
+
+/// FastComputer that reports D wrongly once it is two.
+class FaultyComputer : public FastComputer
+{
+public:
+    using FastComputer::FastComputer;
+
+    uint16_t d() const
+    {
+        uint16_t d = FastComputer::d();
+        return d == 2 ? 0x0102 : d;
+    }
+};
+
+/// Computer that counts its updates.
+class CountingComputer : public Computer
+{
+public:
+    static inline uint64_t updates;
+
+    using Computer::Computer;
+
+    void update() override
+    {
+        updates++;
+        Computer::update();
+    }
+};
+
+static void test_cosimulation()
+{
+    assert(disassemble(0x0004) == "0x0004");
+    assert(disassemble(0x8715) == "OP_DEC | DEST_D | COND_LT | COND_GT");
+    assert(disassemble(SM | OP_ADD | DEST_PA | ALWAYS) == "OP_ADD | SM | DEST_PA | ALWAYS");
+    assert(disassemble(HALT) == "HALT");
+
+    auto program = example_program();
+    Cosimulation<Computer> sim{program};
+    assert(sim.run(100));
+    assert(sim.halted());
+    assert(sim.cycles() == 8);
+    assert(sim.checks() == 8);
+    assert(sim.trace().empty());
+
+    program = memory_program();
+    Cosimulation<OptimizedComputer> sim2{program, 7};
+    assert(sim2.run(40));
+    assert(!sim2.halted());
+    assert(sim2.cycles() == 40);
+    assert(sim2.checks() == 6);
+    assert(sim2.model().ram(2) == sim2.reference().ram(2));
+
+    for (uint32_t seed = 200; seed < 208; ++seed) {
+        program = random_program(seed);
+        Cosimulation<Computer> sim3{program, 3};
+        assert(sim3.run(40));
+    }
+
+    // Between checks only the reference is clocked, if the model can load its state.
+    static_assert(Cosimulation<CountingComputer>::periodic);
+    static_assert(!Cosimulation<OptimizedComputer>::periodic);
+    program = memory_program();
+    for (unsigned interval : {1, 7, 8, 40}) {
+        CountingComputer::updates = 0;
+        Cosimulation<CountingComputer> sim4{program, interval};
+        assert(sim4.run(40));
+        assert(sim4.cycles() == 40);
+        // Each interval, and the last cycle; two updates per cycle.
+        uint64_t compared = (40 + interval - 1) / interval;
+        assert(sim4.checks() == compared);
+        assert(CountingComputer::updates == 2 * compared);
+        for (size_t address = 0; address < 16; ++address) {
+            assert(sim4.model().ram(address) == sim4.reference().ram(address));
+        }
+    }
+
+    // Cycles that halt the reference are compared.
+    program = example_program();
+    CountingComputer::updates = 0;
+    Cosimulation<CountingComputer> sim5{program, 100};
+    assert(sim5.run(100));
+    assert(sim5.halted());
+    assert(sim5.cycles() == 8);
+    assert(sim5.checks() == 1);
+    assert(CountingComputer::updates == 2);
+
+    // Every cycle: diverges as soon as D is two, after cycle 5.
+    program = example_program();
+    Cosimulation<FastComputer, FaultyComputer> faulty{program};
+    assert(!faulty.run(100));
+    assert(faulty.diverged());
+    assert(faulty.divergence().cycle == 5);
+    assert(faulty.divergence().what == "d");
+    assert(faulty.divergence().model == 2);
+    assert(faulty.divergence().reference == 0x0102);
+    assert(faulty.trace().size() == 1);
+    assert(faulty.trace()[0].pc == 3);
+    assert(faulty.trace()[0].instr == 0x8715);
+
+    // Every fifth cycle: the trace covers the cycles since the last check.
+    Cosimulation<FastComputer, FaultyComputer> faulty5{program, 5};
+    assert(!faulty5.run(100));
+    assert(faulty5.divergence().cycle == 5);
+    assert(faulty5.checks() == 1);
+    assert(faulty5.trace().size() == 5);
+    assert(faulty5.trace()[0].cycle == 0);
+    assert(faulty5.trace()[0].instr == 0x0004);
+
+    // Every fourth cycle: D is never two when checked.
+    Cosimulation<FastComputer, FaultyComputer> faulty4{program, 4};
+    assert(faulty4.run(100));
+    assert(faulty4.halted());
+    assert(faulty4.checks() == 2);
+}
+
+/// Run Computer until halt, or at most @c cycles clock cycles.
+static ArchState reference_state(std::vector<uint16_t> program, unsigned cycles)
+{
+    Signal clk;
+    Signal halt;
+    Computer g{program, clk, halt};
+    for (unsigned i = 0; i < cycles && !halt.get(); ++i) {
+        clk.set(1);
+        g.update();
+        clk.set(0);
+        g.update();
+    }
+    return g.state();
+}
+
+static void test_sampled_simulation()
+{
+    auto program = example_program();
+    SampledSimulation sim{program, 3, 2};
+    sim.run(100);
+    assert(sim.halted());
+    assert(sim.cycles() == 8);
+    assert(sim.gate_cycles() == 2);
+    assert(sim.windows() == 1);
+    assert(sim.mismatches() == 0);
+    assert(sim.state().pc == 5);
+
+    // All windows, or no windows.
+    SampledSimulation gates{program, 0, 0};
+    gates.run(100);
+    assert(gates.cycles() == 8);
+    assert(gates.gate_cycles() == 8);
+    SampledSimulation fast{program, 5, 0};
+    fast.run(100);
+    assert(fast.cycles() == 8);
+    assert(fast.gate_cycles() == 0);
+
+    std::vector<std::vector<uint16_t>> programs{memory_program()};
+    for (uint32_t seed = 300; seed < 308; ++seed) {
+        programs.push_back(random_program(seed));
+    }
+    for (auto& p : programs) {
+        SampledSimulation s{p, 7, 4};
+        s.run(30);
+        s.run(30);
+        assert(s.mismatches() == 0);
+        auto expect = reference_state(p, 60);
+        assert(s.cycles() <= 60);
+        assert(s.state().pc == expect.pc);
+        assert(s.state().a == expect.a);
+        assert(s.state().d == expect.d);
+        assert(s.state().ram == expect.ram);
+    }
+}
+
+int main()
+{
+    test_netlist();
+    test_interpreter();
+    test_flat_computer();
+    test_clone();
+    test_event_computer();
+    test_levelization();
+    test_jit();
+    test_optimization();
+    test_partition();
+    test_sliced_computer();
+    test_wide();
+    test_mixed_computer();
+    test_fast_computer();
+    test_baked_computer();
+    test_netlist_file();
+    test_cosimulation();
+    test_sampled_simulation();
+}